@@ -1,516 +1,1054 @@
 #include <iostream>
 #include <ostream>
 #include <algorithm>
+#include <chrono>
 #include "SATSolver.h"
 
 /**
- * Assign a assigning_value to the literal base on 2 watched literals structure of clauses.
- * All associated data structures will be updated accordingly.
- * Does not creating a new assignment object.
- * If the last free literal is another watched literal of the clause, the clause is unit clause and gets push to unit_queue
- * No free literal left but clause still is UNSAT, report conflict and break from loop
- * @param assigning_value Value assign to the literal
- */
-void Literal::assignValueCDCL(bool assigning_value, bool status) {
-    if (this->isFree) {
-        this->isFree = false;
-        this->value = assigning_value;
-        this->branching_level = Assignment::bd;
-        auto* new_assignment = new Assignment(status, this);
-        new_assignment->updateStaticData();
-
-        // Avoid duplicate literal in unit_queue by push to unordered_set
-        std::unordered_set<Literal*> unit_queue_literals;
-        if (assigning_value == true) {
-            // Firstly remove this literal from free_literals list of clauses, then modify related data.
-            for (auto clause : this->pos_occ) {
-                clause->free_literals.erase(this);
-                clause->SAT = true;
-                clause->sat_by.insert(this);
-            }
-            for (auto clause : this->neg_occ) {
-                clause->free_literals.erase(this);
-                // if the clause is SAT by previously assigned literal, skip this clause
-                if (clause->SAT) continue;
-                // if there are no free literals and clause UNSAT, report CONFLICT
-                if (clause->free_literals.empty()) {
-                    clause->reportConflict();
-                }
-                // this literal is in neg_occ and is watched, meaning the clause is in neg_watched
-                if (this->neg_watched_occ.contains(clause)) {
-                    // Find another free literal b if two conditions above are not satisfied
-                    if (clause->free_literals.size() == 1) { // only free literal left is the other watched literal
-                        unit_queue_literals.insert((*clause->free_literals.begin()));
-                        (*clause->free_literals.begin())->reason = clause;
-                    } else { // >=2 free literals left
-                        for (auto l : clause->free_literals) {
-                            // find new watched literal
-                            if (l != clause->watched_literal_1 && l != clause->watched_literal_2) { // l is not watched
-                                Literal* new_watched_literal_b = l;
-                                // set a new watched literal of the clause
-                                if (this == clause->watched_literal_1) clause->watched_literal_1 = new_watched_literal_b;
-                                else clause->watched_literal_2 = new_watched_literal_b;
-                                // remove/add the clause from/to watched clause list of old/new literal
-                                this->neg_watched_occ.erase(clause);
-                                if (clause->pos_literals_list.contains(new_watched_literal_b)) new_watched_literal_b->pos_watched_occ.insert(clause);
-                                else new_watched_literal_b->neg_watched_occ.insert(clause);
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-
-        } else { // Same as above with opposite occur list, changes are highlight with //***
-            for (auto clause : this->neg_occ) { //***
-                clause->free_literals.erase(this);
-                clause->SAT = true;
-                clause->sat_by.insert(this);
-            }
-            for (auto clause : this->pos_occ) { //***
-                clause->free_literals.erase(this);
-                if (clause->SAT) continue;
-                if (clause->free_literals.empty()) {
-                    clause->reportConflict();
-                }
-                if (this->pos_watched_occ.contains(clause)) {
-                    if (clause->free_literals.size() == 1) {
-                        unit_queue_literals.insert((*clause->free_literals.begin()));
-                        (*clause->free_literals.begin())->reason = clause;
-                    } else {
-                        for (auto l : clause->free_literals) {
-                            if (l != clause->watched_literal_1 && l != clause->watched_literal_2) {
-                                Literal* new_watched_literal_b = l;
-                                if (this == clause->watched_literal_1) clause->watched_literal_1 = new_watched_literal_b;
-                                else clause->watched_literal_2 = new_watched_literal_b;
-                                this->pos_watched_occ.erase(clause); //***
-                                if (clause->pos_literals_list.contains(new_watched_literal_b)) new_watched_literal_b->pos_watched_occ.insert(clause);
-                                else new_watched_literal_b->neg_watched_occ.insert(clause);
-                                break;
-                            }
-                        }
-                    }
+ * Run CDCL search on the formula read by this->readDIMACS() until it is solved, this->time_limit runs out or this->interrupt is set.
+ * Can be called again with other assumptions, learned clauses, activities and phases are kept.
+ * Preprocessing runs before the first call only. Without this->incremental it assigns pure literals and removes variables,
+ * assumptions must not use these variables: removed ones and the negation of a pure literal are refused.
+ * Assumptions on variables beyond var_count add them as free variables.
+ * @param assumptions Literals which must be true, decided before any other variable
+ * @return SAT competition exit code: 10 SAT, 20 UNSAT (under the assumptions if this->isUNSAT is false), 0 unknown or refused assumptions
+ */
+int Solver::solve(const std::vector<Lit>& assumptions) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> run_time{0};
+    if (!this->preprocessed) {
+        this->preprocessing();
+        this->preprocessed = true;
+    }
+    // values of the previous call, only those of depth 0 are permanent
+    this->cancelUntil(0);
+    for (Var v = 0; v < this->var_count && this->eliminated_count > 0; v++) {
+        if (this->eliminated[v]) this->values[2 * v] = this->values[2 * v + 1] = 0;
+    }
+    this->isSAT = false;
+    for (Lit l : assumptions) {
+        Var v = Literal::var(l);
+        if (v >= this->var_count) {
+            this->init(v + 1);
+        } else if (this->eliminated[v]) {
+            std::cerr << "Assumption " << Literal::toDIMACS(l) << " uses a variable removed by preprocessing" << std::endl;
+            return 0;
+        } else if (this->pure[v] && this->isFalse(l)) {
+            // pure literals are only a choice of preprocessing, their negation can still be SAT
+            std::cerr << "Assumption " << Literal::toDIMACS(l) << " negates a pure literal fixed by preprocessing" << std::endl;
+            return 0;
+        }
+    }
+    this->assumptions = assumptions;
+    this->assumption_head = 0;
+    this->failed_assumption = Lit_Undef;
+    this->failed_assumptions.clear();
+    while (!this->isSAT && !this->isUNSAT && this->failed_assumption == Lit_Undef && run_time.count() < this->time_limit
+           && !(this->interrupt && this->interrupt->load(std::memory_order_relaxed))) {
+        this->unitPropagationCDCL();
+        if (!this->isSAT && !this->isUNSAT && this->isPropagated() && !this->CONFLICT) {
+            this->branchingCDCL();
+        }
+        if (!this->isSAT && !this->isUNSAT && this->CONFLICT) {
+            this->conflictAnalyze();
+            if (!this->isUNSAT) {
+                this->backtrackingCDCL();
+                this->reduceDB();
+                if (this->shouldRestart()) this->restart();
+                if (this->bd == 0 && this->total_conflict_count >= this->next_subsume) {
+                    this->subsumeClauses(true);
+                    this->next_subsume = this->total_conflict_count + this->subsume_interval;
                 }
+                if (this->bd == 0 && !this->shared_clauses.empty()) this->importSharedClauses();
             }
         }
+        run_time = std::chrono::high_resolution_clock::now() - start_time;
+    }
+    if (this->isSAT && this->eliminated_count > 0) this->extendModel();
+    if (this->failed_assumption != Lit_Undef && !this->isUNSAT) this->analyzeFinal(this->failed_assumption);
+    return this->isSAT ? 10 : this->isUNSAT || this->failed_assumption != Lit_Undef ? 20 : 0;
+}
 
-        for (Literal* l : unit_queue_literals) {
-            Literal::unit_queue.push(l);
-        }
+/**
+ * Assign a assigning_value to the literal base on 2 watched literals structure of clauses.
+ * The literal is pushed to the trail, clauses watching the falsified literal are visited later by unitPropagationCDCL().
+ * A branching literal is the first literal assigned after this->newBranchingLevel().
+ * With chronological backtracking a forced literal gets the depth of its reason, which can be lower than bd.
+ * @param l Literal becoming true
+ * @param reason Clause or binary clause forcing the value, none for branching and preprocessing
+ */
+void Solver::assignValueCDCL(Lit l, Reason reason) {
+    Var v = Literal::var(l);
+    if (this->isFree(v)) {
+        this->values[l] = 1;
+        this->values[Literal::neg(l)] = -1;
+        this->branching_level[v] = reason.isNone() || this->chrono_threshold < 0 ? this->bd : this->getReasonLevel(reason);
+        this->reason[v] = reason;
+        this->trail.push_back(l);
     }
 }
 
 /**
- * Unassigned value the literal.
- * Data of related clauses with be updated. Clauses will not be set to UNSAT as long as there is a literal in sat_by list.
+ * Depth a reason forces its literal at: the max depth of its other literals, which are all false.
+ * A reason clause keeps its false literal of max depth at the second position, see setWatchedLiterals() and updateWatchedClauses().
+ * @param reason Clause or binary clause forcing a literal
+ * @return depth of the forced literal
+ */
+int Solver::getReasonLevel(const Reason& reason) {
+    Lit l = reason.clause != CRef_Undef ? this->arena[reason.clause].literals[1] : reason.binary_literal;
+    return this->branching_level[Literal::var(l)];
+}
+
+/**
+ * Unassigned value the literal, its value is saved as phase for the next branching.
+ * No clause is touched: watched literals stay valid when literals become free again.
  * branching_level got reset.
- * Choose the second watched literal for learned clauses
  */
-void Literal::unassignValueCDCL() {
-    this->setFree();
+void Solver::unassignValueCDCL(Var v) {
+    this->saved_phase[v] = this->values[2 * v];
+    this->values[2 * v] = 0;
+    this->values[2 * v + 1] = 0;
 
-    // "reason" field is not reassigned to null
+    // "reason" field is not reassigned to CRef_Undef
     // since it can remove the learned clause as "reason" from the source branching literal when learning cut
-//    this->reason = nullptr;
+//    this->reason[v] = {};
 
-    if (this->value == true) {
-        for (auto clause : this->pos_occ) {
-            clause->sat_by.erase(this);
-            if (clause->sat_by.empty()) {
-                clause->SAT = false;
-            }
-            clause->free_literals.insert(this);
-            // Only learned clauses don't have second watched literal when reaching here.
-            // Avoid mark the first watched literal second time.
-            if (clause->watched_literal_1 != this && clause->watched_literal_2 == nullptr) {
-                clause->watched_literal_2 = this;
-            }
-        }
-        for (auto clause : this->neg_occ) {
-            clause->free_literals.insert(this);
-            if (clause->watched_literal_1 != this && clause->watched_literal_2 == nullptr) clause->watched_literal_2 = this;
+    this->branching_level[v] = -1;
+    this->order_heap.insert(v); // free again, available for branching
+    if (this->vmtf_stamp[v] > this->vmtf_stamp[this->vmtf_search]) this->vmtf_search = v;
+}
+
+/**
+ * Analyze the conflict by finding the 1UIP cut in the assignment graph, the graph represented by "value", "branching_level" and "reason" arrays of Literal.
+ * No branching assignment will set up UNSAT flag.
+ * The trail is walked backwards in place: literals of the current depth are only counted, marked in "seen",
+ * and resolved in trail order until a single one is left, the UIP. Literals of lower depths go to the learned clause, depth 0 literals are always false and dropped.
+ * The learned clause is built in a reused buffer, its first literal is the flipped UIP.
+ * After chronological backtracking the conflict can be below bd, the trail is first cut to the depth of the conflict.
+ * A conflict with a single literal of that depth is a missed implication, see assertMissedImplication().
+ */
+void Solver::conflictAnalyze() {
+    int conflict_level = 0;
+    int conflict_level_count = 0;
+    auto count_level = [&](Lit q) {
+        int level = this->branching_level[Literal::var(q)];
+        if (level > conflict_level) {
+            conflict_level = level;
+            conflict_level_count = 1;
+        } else if (level == conflict_level) {
+            conflict_level_count++;
         }
+    };
+    if (this->conflict_clause != CRef_Undef) {
+        for (Lit q : this->arena[this->conflict_clause]) count_level(q);
+    } else {
+        count_level(this->conflict_binary[0]);
+        count_level(this->conflict_binary[1]);
+    }
+    if (conflict_level == 0) {
+        this->isUNSAT = true; // CONFLICT when there are no branching (all forced assignments) means formula unsatisfiable
+        return;
+    }
+    this->cancelUntil(conflict_level);
+    if (conflict_level_count == 1) {
+        this->assertMissedImplication();
+        return;
+    }
+    std::vector<Lit>& learned = this->learned_literals;
+    learned.clear();
+    learned.push_back(Lit_Undef); // place of the UIP
+    this->analyze_seen_vars.clear();
+    bool use_VMTF = this->branching_heuristic == "VMTF";
+
+    // mark a false literal of a clause on the conflict side: counted if of the current depth, learned otherwise
+    auto visit = [&](Lit q, int& path_count) {
+        Var v = Literal::var(q);
+        if (this->seen[v] || this->branching_level[v] == 0) return;
+        this->seen[v] = 1;
+        this->analyze_seen_vars.push_back(v);
+        if (!use_VMTF) this->bumpActivity(v);
+        if (this->branching_level[v] >= this->bd) path_count++;
+        else learned.push_back(q);
+    };
+
+    int path_count = 0;
+    // initial cut is the conflicted clause
+    if (this->conflict_clause != CRef_Undef) {
+        this->bumpClauseActivity(this->conflict_clause);
+        for (Lit q : this->arena[this->conflict_clause]) visit(q, path_count);
     } else {
-        for (auto clause : this->neg_occ) {
-            clause->sat_by.erase(this);
-            if (clause->sat_by.empty()) {
-                clause->SAT = false;
+        visit(this->conflict_binary[0], path_count);
+        visit(this->conflict_binary[1], path_count);
+    }
+    int i = static_cast<int>(this->trail.size()) - 1;
+    Lit uip;
+    while (true) {
+        // next marked literal of the current depth in trail order, marked literals of lower depths are in the learned clause
+        while (!this->seen[Literal::var(this->trail[i])] || this->branching_level[Literal::var(this->trail[i])] < this->bd) i--;
+        uip = this->trail[i--];
+        Var uip_var = Literal::var(uip);
+        this->seen[uip_var] = 0;
+        path_count--;
+        if (path_count == 0) break;
+        // Go up the graph through the edge (reason) and resolve
+        const Reason& r = this->reason[uip_var];
+        if (r.clause != CRef_Undef) {
+            this->bumpClauseActivity(r.clause);
+            for (Lit q : this->arena[r.clause]) {
+                if (Literal::var(q) != uip_var) visit(q, path_count);
             }
-            clause->free_literals.insert(this);
-            if (clause->watched_literal_1 != this && clause->watched_literal_2 == nullptr) clause->watched_literal_2 = this;
+        } else {
+            visit(r.binary_literal, path_count);
+        }
+    }
+    learned[0] = Literal::neg(uip);
+    if (use_VMTF) this->bumpVMTF(this->analyze_seen_vars);
+    this->learned_literal_count += learned.size();
+    this->minimizeLearned(learned);
+    this->minimized_literal_count += learned.size();
+    for (Var v : this->analyze_seen_vars) this->seen[v] = 0;
 
+    // learn asserting clause
+    this->learnCut(learned);
+    this->decayActivities();
+    this->decayClauseActivities();
+}
+
+/**
+ * The conflict clause has one literal of max depth, it is unit since that depth and only wasn't propagated because
+ * the literal was assigned earlier at a higher depth (chronological backtracking). Nothing is learned:
+ * the conflict clause is watched again with the literal first and becomes its reason, backtrackingCDCL() assigns it one depth lower.
+ */
+void Solver::assertMissedImplication() {
+    this->learned_clause_assertion_level = this->bd - 1;
+    if (this->conflict_clause != CRef_Undef) {
+        Clause& clause = this->arena[this->conflict_clause];
+        this->learned_clause_lbd = this->computeLBD(clause.begin(), clause.end());
+        this->unwatch(clause);
+        this->cancelUntil(this->learned_clause_assertion_level);
+        this->setWatchedLiterals(clause);
+        this->learned_asserting_literal = clause.literals[0];
+        this->learned_asserting_reason = {this->conflict_clause, Lit_Undef};
+    } else {
+        this->learned_clause_lbd = 2;
+        Lit l1 = this->conflict_binary[0];
+        Lit l2 = this->conflict_binary[1];
+        if (this->branching_level[Literal::var(l1)] < this->branching_level[Literal::var(l2)]) std::swap(l1, l2);
+        this->learned_asserting_literal = l1;
+        this->learned_asserting_reason = Reason::binary(l2);
+    }
+}
+
+/**
+ * Abstraction of a depth as one bit of a 32-bit mask, a set of depths is the OR of their bits.
+ * A literal whose depth bit is not in the mask of the learned clause can't be implied by its literals.
+ */
+uint32_t Solver::abstractLevel(Var v) {
+    return 1u << (this->branching_level[v] & 31);
+}
+
+/**
+ * Remove literals implied by the other literals of the learned clause, literals of the learned clause are marked seen.
+ * "local": a literal is removed if every other literal of its reason is in the clause (or of depth 0).
+ * "recursive": the reasons are followed further back through the implication graph, see isRedundant().
+ * @param learned Learned clause, its first literal (the UIP) is never removed
+ */
+void Solver::minimizeLearned(std::vector<Lit>& learned) {
+    if (this->minimization_mode == "none") return;
+    size_t j = 1;
+    if (this->minimization_mode == "recursive") {
+        uint32_t abstract_levels = 0;
+        for (size_t k = 1; k < learned.size(); k++) abstract_levels |= this->abstractLevel(Literal::var(learned[k]));
+        for (size_t k = 1; k < learned.size(); k++) {
+            Var v = Literal::var(learned[k]);
+            if (this->reason[v].isNone() || !this->isRedundant(learned[k], abstract_levels)) learned[j++] = learned[k];
         }
-        for (auto clause : this->pos_occ) {
-            clause->free_literals.insert(this);
-            if (clause->watched_literal_1 != this && clause->watched_literal_2 == nullptr) clause->watched_literal_2 = this;
+    } else {
+        for (size_t k = 1; k < learned.size(); k++) {
+            Var v = Literal::var(learned[k]);
+            const Reason& r = this->reason[v];
+            bool redundant = !r.isNone();
+            if (r.clause != CRef_Undef) {
+                for (Lit q : this->arena[r.clause]) {
+                    Var u = Literal::var(q);
+                    if (u != v && !this->seen[u] && this->branching_level[u] > 0) {
+                        redundant = false;
+                        break;
+                    }
+                }
+            } else if (redundant) {
+                Var u = Literal::var(r.binary_literal);
+                redundant = this->seen[u] || this->branching_level[u] == 0;
+            }
+            if (!redundant) learned[j++] = learned[k];
         }
     }
-    this->branching_level = -1;
+    learned.resize(j);
 }
 
 /**
- * Analyze the conflict by finding a fitting 1UIP scheme cut in the assignment graph, the graph represented by "value", "branching_depth" and "reason" field of Literal class.
- * No branching assignment will set up UNSAT flag.
- * The cut is represented by list of variable, positive or negative literals is determined when learning.
- * Learn the cut by add clause with flipped value of literals.
+ * Check if the false literal p is implied by the literals marked seen, by a depth-first search over reasons.
+ * Literals proven implied on the way are marked seen as well, so later checks stop at them.
+ * The search fails at a branching literal or at a literal whose depth is not in abstract_levels, marks of the failed search are undone.
+ * @param p Literal of the learned clause with a reason
+ * @param abstract_levels Abstract depths of the learned clause
+ * @return true if p can be removed
  */
-void Clause::conflictAnalyze() {
-    if (Literal::bd2BranLit.empty()) {
-        Formula::isUNSAT = true; // CONFLICT when there are no branching (all forced assignments) means formula unsatisfiable
-    } else {
-        std::unordered_set<Literal*> current_cut = Clause::conflict_clause->getAllLiterals(); // initial cut is the conflicted clause
-        std::stack<Assignment*> stack = Assignment::stack; // making a copy to modify, keeping original assignments history for later unassignValue in backtracking
-        while (!Clause::isAsserting(current_cut)) {
-            // break out of loop if reach the source branching assignment
-            if (stack.top()->status == Assignment::IsBranching) {
-                current_cut.insert(stack.top()->assigned_literal);
-                break;
+bool Solver::isRedundant(Lit p, uint32_t abstract_levels) {
+    std::vector<Lit>& stack = this->minimize_stack;
+    stack.clear();
+    stack.push_back(p);
+    size_t top = this->analyze_seen_vars.size();
+    while (!stack.empty()) {
+        Var v = Literal::var(stack.back());
+        stack.pop_back();
+        const Reason& r = this->reason[v];
+        Lit single[1] = {r.binary_literal};
+        Lit* begin = single;
+        Lit* end = single + 1;
+        if (r.clause != CRef_Undef) {
+            begin = this->arena[r.clause].begin();
+            end = this->arena[r.clause].end();
+        }
+        for (Lit* q = begin; q != end; q++) {
+            Var u = Literal::var(*q);
+            if (u == v || this->seen[u] || this->branching_level[u] == 0) continue;
+            if (!this->reason[u].isNone() && (this->abstractLevel(u) & abstract_levels) != 0) {
+                this->seen[u] = 1;
+                stack.push_back(*q);
+                this->analyze_seen_vars.push_back(u);
             } else {
-                // Go up the graph through edges (reason)
-                std::unordered_set<Literal*> parent_vertexes = stack.top()->assigned_literal->reason->getAllLiterals();
-                parent_vertexes.erase(stack.top()->assigned_literal);
-                current_cut.erase(stack.top()->assigned_literal);
-                stack.pop();// remove top assignment for next loop
-                // Resolving current_cut with new parent_vertexes
-                for (Literal* vertex : parent_vertexes) {
-                    current_cut.insert(vertex);
-                }
+                for (size_t k = top; k < this->analyze_seen_vars.size(); k++) this->seen[this->analyze_seen_vars[k]] = 0;
+                this->analyze_seen_vars.resize(top);
+                return false;
             }
         }
-        // learn asserting clause
-        Clause::learnCut(current_cut);
     }
+    return true;
 }
+
 /**
- * Cut will be parsed to data structure. New clause is created with watched literals, but without calling setNewClause().
- * Literal with max depth will be pushed to unit_queue
+ * The learned clause will be parsed to a new learned clause in the arena, or only to watched lists if it is binary.
+ * Its first literal, the only one of max depth, is saved with the new clause as reason, backtrackingCDCL() assigns it.
  * Update asserting_level for backtracking use.
- * @param cut
+ * @param learned Learned clause, all literals are false, flipped UIP first
  */
-void Clause::learnCut(const std::unordered_set<Literal *>& cut) {
+void Solver::learnCut(std::vector<Lit>& learned) {
     //empty unit clause queue
-    while (!Literal::unit_queue.empty()) {
-        Literal::unit_queue.pop();
-    }
-    // Creat new learned Clause
-    auto* new_clause = new LearnedClause(Clause::count);
-    new_clause->updateLearnedStaticData();
-
-    // the second-largest branching depth of literals in cut
-    Clause::learned_clause_assertion_level = 0;
-    for (Literal* l : cut) {
-        // learn flipped value of literal and add to new_clause. Ex: Old value is "true" -> set variable in new_clause as negative literal
-        if (l->value == true) {
-            Literal::setLiteral(-abs(l->id), new_clause);
-        } else {
-            Literal::setLiteral(abs(l->id), new_clause);
+    this->propagation_head = static_cast<int>(this->trail.size());
+    // the second-largest branching depth of literals, moved to the second position
+    this->learned_clause_assertion_level = 0;
+    for (size_t k = 1; k < learned.size(); k++) {
+        int level = this->branching_level[Literal::var(learned[k])];
+        if (level > this->learned_clause_assertion_level) {
+            this->learned_clause_assertion_level = level;
+            std::swap(learned[1], learned[k]);
         }
-        // update assertion level
-        if (l->branching_level < Assignment::bd && l->branching_level > Clause::learned_clause_assertion_level) {
-            Clause::learned_clause_assertion_level = l->branching_level;
-        } else if (l->branching_level == Assignment::bd) {
-            // enqueue new learn clause as unit clause, literal with the highest depth (the old branching literal) is push to unit_queue
-            Literal::unit_queue.push(l);
-            l->reason = new_clause;
-            new_clause->watched_literal_1 = l; // mark first watched literal, second one is assigned later by first time unassigned
-
-            Printer::solution.insert(l);
-            if (Printer::print_max_depth_literal) {
-                l->printData();
-                std::cout<< "has depth " << l->branching_level << "\n";
-                std::cout << "Max depth " << Assignment::bd << "\n";
-                std::cout << "Assertion level" << Clause::learned_clause_assertion_level << "\n";
+    }
+    // new learn clause becomes unit after backtracking, the UIP gets the flipped value
+    this->learned_asserting_literal = learned[0];
+    if (this->print_max_depth_literal) {
+        this->printData(Literal::var(learned[0]));
+        std::cout << "Max depth " << this->bd << "\n";
+        std::cout << "Assertion level" << this->learned_clause_assertion_level << "\n";
+    }
+    this->learned_clause_lbd = this->computeLBD(learned.data(), learned.data() + learned.size());
+    if (!this->shared_clauses.empty()) this->exportLearned(learned);
+    // Creat new learned Clause, watching the literal of max depth and one of the assertion level
+    this->learned_asserting_reason = {};
+    if (learned.size() == 2) {
+        this->setNewBinaryClause(learned[0], learned[1]);
+        this->learned_asserting_reason = Reason::binary(learned[1]);
+    } else if (learned.size() > 2) {
+        CRef new_clause = this->setNewLearnedClause(learned);
+        this->learned_asserting_reason = {new_clause, Lit_Undef};
+        if (this->print_learned_clause) {
+            this->printData(this->arena[new_clause]);
+            std::cout << this->arena[new_clause].getWidth() << "\n";
+        }
+    }
+}
+
+/**
+ * Collect into this->failed_assumptions the assumption p found false and the assumptions forcing it false with the formula.
+ * The trail is walked back from the negation of p over reasons, assigned literals without reason above depth 0 are assumptions.
+ * @param p Assumption which is false
+ */
+void Solver::analyzeFinal(Lit p) {
+    this->failed_assumptions.assign(1, p);
+    if (this->branching_level[Literal::var(p)] == 0) return;
+    this->seen[Literal::var(p)] = 1;
+    for (int i = static_cast<int>(this->trail.size()) - 1; i >= 0; i--) {
+        Var v = Literal::var(this->trail[i]);
+        if (!this->seen[v]) continue;
+        this->seen[v] = 0;
+        const Reason& r = this->reason[v];
+        if (r.isNone()) {
+            if (this->branching_level[v] > 0) this->failed_assumptions.push_back(this->trail[i]);
+        } else if (r.clause == CRef_Undef) {
+            Var u = Literal::var(r.binary_literal);
+            if (this->branching_level[u] > 0) this->seen[u] = 1;
+        } else {
+            Clause& c = this->arena[r.clause];
+            for (uint32_t k = 1; k < c.size; k++) {
+                Var u = Literal::var(c.literals[k]);
+                if (this->branching_level[u] > 0) this->seen[u] = 1;
             }
         }
-        l->learned_count++;
     }
-    if (Printer::print_learned_clause) {
-        new_clause->printData();
-        std::cout << new_clause->getWidth() << "\n";
+}
+
+/**
+ * Publish a learned clause to the other solvers of the portfolio if it is short and of low LBD.
+ * Copying to the own buffer takes no lock, propagation is not affected.
+ * @param learned Clause just learned, this->learned_clause_lbd is its LBD
+ */
+void Solver::exportLearned(const std::vector<Lit>& learned) {
+    int size = static_cast<int>(learned.size());
+    if (size > 2 && (this->learned_clause_lbd > this->share_lbd_limit || size > ClauseExchange::max_size)) return;
+    this->shared_clauses[this->solver_index]->publish(learned, this->learned_clause_lbd);
+    this->exported_count++;
+}
+
+/**
+ * Add the clauses published by the other solvers since the last import. Only called at depth 0,
+ * after a restart or a backjump to depth 0, so all assigned values are permanent.
+ */
+void Solver::importSharedClauses() {
+    for (size_t i = 0; i < this->shared_clauses.size() && !this->isUNSAT; i++) {
+        if (static_cast<int>(i) == this->solver_index) continue;
+        int lbd;
+        while (!this->isUNSAT && this->shared_clauses[i]->read(this->shared_positions[i], this->shared_literals, lbd)) {
+            this->addSharedClause(this->shared_literals, lbd);
+        }
+    }
+}
+
+/**
+ * Add a clause learned by another solver at depth 0, simplified by addSimplifiedClause().
+ * Clauses with a variable removed by preprocessing are dropped, they can only come from a solver preprocessing differently.
+ * @param clause Literals of the clause, changed
+ * @param lbd LBD of the clause in the solver which learned it
+ */
+void Solver::addSharedClause(std::vector<Lit>& clause, int lbd) {
+    if (std::any_of(clause.begin(), clause.end(), [this](Lit l) {return this->eliminated[Literal::var(l)];})) return;
+    this->imported_count++;
+    this->addSimplifiedClause(clause, true, lbd);
+}
+
+/**
+ * Literal block distance: number of different depths of the literals.
+ * @param literals Assigned literals
+ * @return LBD
+ */
+int Solver::computeLBD(const Lit* begin, const Lit* end) {
+    this->lbd_stamp_count++;
+    int lbd = 0;
+    for (const Lit* l = begin; l != end; l++) {
+        int level = this->branching_level[Literal::var(*l)];
+        if (level < 0) continue;
+        if (this->lbd_stamp[level] != this->lbd_stamp_count) {
+            this->lbd_stamp[level] = this->lbd_stamp_count;
+            lbd++;
+        }
     }
+    return lbd;
 }
 
 /**
  * Should be called immediately after analyzing conflict. Could be skipped if UNSAT flag is raised by conflictAnalyze()
- * Assignment stack will be pop all assignment with depth > asserting level d of the learn clause (non-chronological backtracking)
+ * Trail is truncated to the start of depth asserting level d + 1 of the learn clause (non-chronological backtracking)
+ * If the jump is longer than this->chrono_threshold only the last depth is undone (chronological backtracking),
+ * the asserting literal is then assigned at its assertion level above literals of higher depths. Learned units always go to depth 0.
  * Literals will be unassigned accordingly.
  */
-void Assignment::backtrackingCDCL() {
-    // pop all forced assignment, stop at last branchingDPLL assignment or stack empty
-    while (!Assignment::stack.empty() && Assignment::stack.top()->assigned_literal->branching_level > Clause::learned_clause_assertion_level) {
-        Assignment* top_assignment = Assignment::stack.top();
-        if (top_assignment->status == Assignment::IsBranching) {
-            Literal::bd2BranLit.erase(top_assignment->assigned_literal->branching_level);
-        }
-        top_assignment->assigned_literal->unassignValueCDCL();
-        Assignment::stack.pop();
-        delete top_assignment;
-    }
+void Solver::backtrackingCDCL() {
     /**
-     * branching literal has highest depth bd which always > asserting level, is popped in while loop
-     * Tracking old value of branching literal and emptying unit_queue are done by learnCut()
-     * assigning flipped value is done by unitPropagation
+     * branching literal has highest depth bd which always > asserting level, is removed by the truncation
+     * Tracking old value of branching literal is done by learnCut()
+     * the learned clause is unit now, assigning flipped value with it as reason
      */
+    this->updateTargetPhases();
+    this->updateRestartData(this->learned_clause_lbd, static_cast<int>(this->trail.size()));
+    int level = this->learned_clause_assertion_level;
+    if (this->chrono_threshold >= 0 && level > 0 && this->bd - level > this->chrono_threshold) {
+        level = this->bd - 1;
+        this->chrono_backtrack_count++;
+    }
+    this->cancelUntil(level);
 
     // backtracking successfully
-    Assignment::bd = Clause::learned_clause_assertion_level;
-    Clause::CONFLICT = false;
-    Clause::conflict_clause = nullptr;
-    if (Printer::print_CDCL_process) std::cout << "Backtracking successfully" << "\n";
+    this->CONFLICT = false;
+    this->conflict_clause = CRef_Undef;
+    if (this->learned_asserting_literal != Lit_Undef) {
+        this->assignValueCDCL(this->learned_asserting_literal, this->learned_asserting_reason);
+        this->learned_asserting_literal = Lit_Undef;
+    }
+    if (this->print_CDCL_process) std::cout << "Backtracking successfully" << "\n";
 }
 
 /**
- * find and propagate all literal in unit_queue and assign value to these literal by force
+ * propagate all assigned literals from the propagation head to the end of the trail, literals becoming unit on the way are assigned by force and appended as well
  */
-void Clause::unitPropagationCDCL() {
-    if (Printer::print_CDCL_process) std::cout << "Unit propagating..." << "\n";
-    while (!(Literal::unit_queue.empty()) && !Clause::CONFLICT) {
-        Literal* next_literal = Literal::unit_queue.front();
-        Literal::unit_queue.pop();
-        Clause* unit_clause = next_literal->reason;
-        // check literal is positive or negative in the unit clause to assign fitting value
-        if (unit_clause->pos_literals_list.count(next_literal) >= 1) {
-            next_literal->assignValueCDCL(true, Assignment::IsForced);
-        } else {
-            next_literal->assignValueCDCL(false, Assignment::IsForced);
-        }
-        if (Printer::print_assignment) std::cout << "Literal " << next_literal->id << " forcing " << next_literal->value << "\n";
+void Solver::unitPropagationCDCL() {
+    if (this->print_CDCL_process) std::cout << "Unit propagating..." << "\n";
+    while (!this->isPropagated() && !this->CONFLICT) {
+        Lit next_literal = this->trail[this->propagation_head++];
+        this->propagation_count++;
+        this->updateWatchedClauses(Literal::neg(next_literal));
+        if (this->print_assignment) std::cout << "Literal " << Literal::var(next_literal) + 1 << " forcing " << !Literal::sign(next_literal) << "\n";
     }
 }
 
 /**
- * Set up 2 watched literals for clause. If it's unit clause, push to unit_queue.
- * Also remove initial clauses with 2 literals of the same variable. a v -a
+ * Branching in case all assignments are propagated (no unit clause), no CONFLICT, no SAT or UNSAT flag.
+ * Function using heuristics VSIDS to choose a literal then assign value.
  */
-void Clause::setWatchedLiterals() {
-    int clause_size = this->pos_literals_list.size() + this->neg_literals_list.size();
-    if (clause_size >= 2) {
-        if (this->free_literals.size() >= 2) {
-            // Choose 2 random watched literals for the clause
-            if (!this->SAT && clause_size >= 2) { // Only SATable by prepocessing(),
-                this->watched_literal_1 = *(this->free_literals.begin()); // randomly access due to unordered
-                std::unordered_set<Literal*> unwatched_free_literals = this->free_literals;
-                unwatched_free_literals.erase(this->watched_literal_1);
-                this->watched_literal_2 = *(unwatched_free_literals.begin());
-            }
-            // Add clause address to pos/neg_watched_occ of watched literals
-            if (this->pos_literals_list.contains(this->watched_literal_1)) {
-                this->watched_literal_1->pos_watched_occ.insert(this);
-            } else {
-                this->watched_literal_1->neg_watched_occ.insert(this);
-            }
-            if (this->pos_literals_list.contains(this->watched_literal_2)) {
-                this->watched_literal_2->pos_watched_occ.insert(this);
-            } else {
-                this->watched_literal_2->neg_watched_occ.insert(this);
-            }
-        } else if (this->free_literals.size() == 1) { // Clause's width = 2 with 1 free_literal
-            this->deleteClause();
+void Solver::branchingCDCL() {
+    if (this->print_process) std::cout << "Start branchingCDCL " << "\n";
+
+    this->branching_count++;
+    while (this->assumption_head < this->assumptions.size()) {
+        Lit l = this->assumptions[this->assumption_head++];
+        if (this->isTrue(l)) continue;
+        if (this->isFalse(l)) {
+            this->failed_assumption = l;
+        } else {
+            this->newBranchingLevel();
+            this->assignValueCDCL(l);
         }
+        return;
+    }
+    std::tuple<Var, bool> t = this->branching_heuristic == "VMTF" ? this->VMTF() : this->VSIDS();
+    Var branching_variable = std::get<0>(t);
+    bool assigning_value = std::get<1>(t);
+    if (branching_variable == Var_Undef) {
+        // all literals are assigned without conflict, so every clause is SAT by the watched literals invariant
+        this->isSAT = true;
+    } else {
+        this->newBranchingLevel();
+        this->decision_count++;
+        // branching literal has no parent vertexes, reason stays none
+        this->assignValueCDCL(Literal::makeLit(branching_variable, !assigning_value));
+        if (this->print_assignment) std::cout << "Literal " << branching_variable + 1 << " branching" << assigning_value << "\n";
+        if (this->print_process) std::cout << "Finished branchingCDCL " << std::endl;
     }
 }
 
 /**
- * Branching in case unit_queue is empty (no unit clause), no CONFLICT, no SAT or UNSAT flag.
- * Function using heuristics VSIDS to choose a literal then assign value.
+ * Branch on a literal and propagate it, without conflict analysis. Used by the lookahead.
+ * @param l Free literal
+ * @return false if propagation ends in a conflict
  */
-void Assignment::branchingCDCL() {
-    if (Printer::print_process) std::cout << "Start branchingCDCL " << "\n";
+bool Solver::decide(Lit l) {
+    this->newBranchingLevel();
+    this->assignValueCDCL(l);
+    this->unitPropagationCDCL();
+    return !this->CONFLICT;
+}
 
-    Assignment::bd++;
-    Formula::branching_count++;
-    // VSIDS heuristic
-    if (Formula::branching_count == 250) {
-        Literal::updatePriorities();
-        Formula::branching_count = 0;
+/**
+ * Take back decisions of decide() and a conflict found by their propagation.
+ * @param level Depth to keep
+ */
+void Solver::undoDecisions(int level) {
+    this->cancelUntil(level);
+    this->CONFLICT = false;
+    this->conflict_clause = CRef_Undef;
+}
+
+/**
+ * Choose the variable splitting the formula best. The variables of most occurrences in clauses not yet SAT, counted like MOM does,
+ * are propagated with both values, the one whose values assign the most literals wins.
+ * A value ending in a conflict is refuted, its variable is taken at once since only the other branch remains.
+ * @return Chosen variable, Var_Undef if no free variable occurs in a clause not yet SAT
+ */
+Var Solver::lookaheadVariable() {
+    std::vector<std::pair<long long, Var>> candidates;
+    for (Var v = 0; v < this->var_count; v++) {
+        if (!this->isFree(v) || this->eliminated[v]) continue;
+        long long pos_occ = this->getActualOcc(Literal::makeLit(v, false), INT_MAX);
+        long long neg_occ = this->getActualOcc(Literal::makeLit(v, true), INT_MAX);
+        if (pos_occ + neg_occ > 0) candidates.emplace_back(pos_occ * neg_occ + pos_occ + neg_occ, v);
     }
-    std::tuple<Literal*, bool> t = Heuristic::VSIDS();
-    Literal* branching_literal = std::get<0>(t);
-    bool assigning_value = std::get<1>(t);
-    if (std::get<0>(t) != nullptr) {
-        branching_literal->assignValueCDCL(assigning_value, Assignment::IsBranching);
-        // some update for literal
-        branching_literal->reason = nullptr; // branching literal has no parent vertexes
-        Literal::bd2BranLit[Assignment::bd] = branching_literal;
-        if (Printer::print_assignment) std::cout << "Literal " << branching_literal->id << " branching" << branching_literal->value << "\n";
-        if (Printer::print_process) std::cout << "Finished branchingCDCL " << std::endl;
+    size_t count = std::min(candidates.size(), static_cast<size_t>(this->lookahead_candidates));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), std::greater<>());
+
+    Var chosen_variable = Var_Undef;
+    long long best_score = -1;
+    int level = this->bd;
+    for (size_t i = 0; i < count; i++) {
+        Var v = candidates[i].second;
+        long long assigned[2];
+        bool refuted = false;
+        for (int negative = 0; negative < 2; negative++) {
+            size_t trail_size = this->trail.size();
+            refuted |= !this->decide(Literal::makeLit(v, negative));
+            assigned[negative] = static_cast<long long>(this->trail.size() - trail_size);
+            this->undoDecisions(level);
+        }
+        if (refuted) return v;
+        long long score = (assigned[0] + 1) * (assigned[1] + 1);
+        if (score > best_score) {
+            best_score = score;
+            chosen_variable = v;
+        }
     }
+    return chosen_variable;
 }
 
 /**
- * Test if the cut the highest possible in the graph,
- * meaning all vertexes in branching side (B side) are source vertexes with edges to cutting side (C side).
- * This is the chosen learning cut for decision scheme, but worst-case for RelSAT and 1UIP scheme
- * @param cut A cut represent by a set of literal
- * @return true if all literals in cut are branching, false otherwise
+ * Split the formula into cubes for cube-and-conquer. Only the formula is used, nothing is learned.
+ * Cubes refuted by propagation are left out, so the formula is UNSAT if and only if all returned cubes are.
+ * Cube literals are free variables of the preprocessed formula, never eliminated or substituted ones. They are valid assumptions
+ * only for solvers built with the same options, which preprocess the formula the same way.
+ * @param depth Number of splits, at most 2^depth cubes
+ * @return Cubes as lists of assumptions, empty if the formula is UNSAT already (this->isUNSAT is set)
  */
-bool Clause::isDecisionCut(const std::unordered_set<Literal *>& cut) {
-    for (Literal* l : cut) {
-        // If l is branching literal, l is in bd2BranLit dict as a branching literal
-        bool l_is_branching_source = Literal::bd2BranLit[l->branching_level] == l;
-        if (!l_is_branching_source) {
-            return false;
-        }
+std::vector<std::vector<Lit>> Solver::splitCubes(int depth) {
+    std::vector<std::vector<Lit>> cubes;
+    if (!this->preprocessed) {
+        this->preprocessing();
+        this->preprocessed = true;
     }
-    return true;
+    this->unitPropagationCDCL();
+    if (this->CONFLICT) this->isUNSAT = true;
+    if (this->isUNSAT) return cubes;
+    std::vector<Lit> cube;
+    this->splitCube(cube, depth, cubes);
+    this->undoDecisions(0);
+    return cubes;
 }
 
 /**
- * Finding if a cut is asserting, meaning contain only one literal with max branching depth
- * @param cut graph cut
- * @return true if asserting, false otherwise
+ * Add the cubes extending a cube, whose literals are decided and propagated without conflict.
+ * @param cube Decided literals, restored on return
+ * @param depth Splits left
+ * @param cubes Found cubes
  */
-bool Clause::isAsserting(const std::unordered_set<Literal *>& cut) {
-    int maximal_bd_literal_count = 0;
-    for (Literal* l : cut) {
-        if (l->branching_level == Assignment::bd) maximal_bd_literal_count++;
-        if (maximal_bd_literal_count > 1) return false;
+void Solver::splitCube(std::vector<Lit>& cube, int depth, std::vector<std::vector<Lit>>& cubes) {
+    Var v = depth > 0 ? this->lookaheadVariable() : Var_Undef;
+    if (v == Var_Undef) {
+        cubes.push_back(cube);
+        return;
     }
-    if (maximal_bd_literal_count == 1) return true;
-    else {
-        std::cerr << "Cut contain no literal with max bd" << std::endl;
-        return true;
+    int level = this->bd;
+    for (int negative = 0; negative < 2; negative++) {
+        Lit l = Literal::makeLit(v, negative);
+        if (this->decide(l)) {
+            cube.push_back(l);
+            this->splitCube(cube, depth - 1, cubes);
+            cube.pop_back();
+        }
+        this->undoDecisions(level);
     }
 }
+
 /**
  * Using VSIDS heuristic to choose a free literal for branching. Value is choose base on pos_occ and neg_occ
- * @return tuple contain address to literal and chosen value for assigning
+ * Assigned variables are removed lazily from the heap, they are inserted again when unassigned.
+ * @return tuple contain chosen variable, Var_Undef if all are assigned, and chosen value for assigning
  */
-std::tuple<Literal*, bool> Heuristic::VSIDS() {
-    Literal *chosen_literal = nullptr;
+std::tuple<Var, bool> Solver::VSIDS() {
+    Var chosen_variable = Var_Undef;
     bool value = false;
-    std::priority_queue<Literal *, std::vector<Literal *>, Literal::Compare> queue = Literal::pq;
-    // Find the most prioritized free literal
-    while (!queue.top()->isFree && !queue.empty()) {
-        queue.pop();
+    // Find the most prioritized free variable
+    while (!this->order_heap.empty()) {
+        Var v = this->order_heap.removeMax();
+        if (this->isFree(v) && !this->eliminated[v]) {
+            chosen_variable = v;
+            break;
+        }
     }
-    if (!queue.empty()) {
-        chosen_literal = queue.top();
-
-    // Choose value with more actual occur
-        if (chosen_literal->getActualPosOcc(INT_MAX) >= chosen_literal->getActualNegOcc(INT_MAX)) value = true;
-        else value = false;
+    if (chosen_variable != Var_Undef) {
+        value = this->choosePolarity(chosen_variable);
     } else {
-        if (Printer::print_CDCL_process) {
+        if (this->print_CDCL_process) {
             std::cout << "Can't branching, all literals are assigned." << "\n";
-            Printer::printAssignmentStack();
+            this->printAssignmentStack();
         }
-        if (!Formula::isSAT && !Formula::isSAT && !Clause::CONFLICT) {
+        if (!this->isSAT && !this->isSAT && !this->CONFLICT) {
         }
     }
-    return std::make_tuple(chosen_literal, value);
+    return std::make_tuple(chosen_variable, value);
 }
 
-void LearnedClause::updateLearnedStaticData() {
-    this->updateStaticData();
-    LearnedClause::learned_list.insert(this);
+/**
+ * Using VMTF heuristic to choose a free literal for branching: the most recently bumped free variable in the queue.
+ * The search starts at the cached vmtf_search instead of the end of the queue, so decisions are amortized O(1).
+ * @return tuple contain chosen variable, Var_Undef if all are assigned, and chosen value for assigning
+ */
+std::tuple<Var, bool> Solver::VMTF() {
+    Var chosen_variable = this->vmtf_search;
+    while (chosen_variable != Var_Undef && (!this->isFree(chosen_variable) || this->eliminated[chosen_variable])) {
+        chosen_variable = this->vmtf_prev[chosen_variable];
+    }
+    if (chosen_variable == Var_Undef) {
+        if (this->print_CDCL_process) std::cout << "Can't branching, all literals are assigned." << "\n";
+        return std::make_tuple(Var_Undef, false);
+    }
+    this->vmtf_search = chosen_variable;
+    return std::make_tuple(chosen_variable, this->choosePolarity(chosen_variable));
 }
 
-void LearnedClause::setWatchedLiteral(Literal * l) {
-    if (this->watched_literal_1 == nullptr) this->watched_literal_1 = l;
-    if (this->watched_literal_2 == nullptr && this->watched_literal_1 != l) this->watched_literal_2 = l;
+/**
+ * Choose the target phase if enabled and set, else the saved phase. Both are single lookups.
+ * @param v Free variable chosen for branching
+ * @return value for assigning
+ */
+bool Solver::choosePolarity(Var v) {
+    if (this->use_target_phase && this->target_phase[v] != 0) return this->target_phase[v] > 0;
+    return this->saved_phase[v] > 0;
 }
 
 /**
- * Update literals' priority base on VSIDS heuristic
+ * Initial phases after preprocessing, computed once for all variables. With this->initial_phase "occurrence" it is the value
+ * with more actual occur, else constant true, false or random. These are the "original" phases for rephasing.
  */
-void Literal::updatePriorities() {
-    // Empty priority queue
-    while (!Literal::pq.empty()) {
-        Literal::pq.pop();
+void Solver::initPhases() {
+    for (Var v = 0; v < this->var_count; v++) {
+        if (!this->isFree(v)) continue;
+        bool value;
+        if (this->initial_phase == "true") value = true;
+        else if (this->initial_phase == "false") value = false;
+        else if (this->initial_phase == "random") value = this->random_generator() & 1;
+        else value = this->getActualOcc(Literal::makeLit(v, false), INT_MAX) >= this->getActualOcc(Literal::makeLit(v, true), INT_MAX);
+        this->original_phase[v] = value ? 1 : -1;
+        this->saved_phase[v] = this->original_phase[v];
     }
-    for (auto [id, literal] : Literal::id2Lit) {
-        // Update
-        literal->prioty_level = literal->prioty_level / 2 + literal->learned_count;
-        literal->learned_count = 0;
-        // Push back to queue for re-sorting base on literals' new priority
-        Literal::pq.push(literal);
+    this->next_rephase = this->total_conflict_count + this->rephase_interval;
+}
+
+/**
+ * Called at a conflict before backtracking. If the trail is longer than the one saved for target or best phases,
+ * its values are saved instead.
+ */
+void Solver::updateTargetPhases() {
+    int assigned = static_cast<int>(this->trail.size());
+    if (this->use_target_phase && assigned > this->target_assigned) {
+        for (Lit l : this->trail) this->target_phase[Literal::var(l)] = Literal::sign(l) ? -1 : 1;
+        this->target_assigned = assigned;
+    }
+    if (assigned > this->best_assigned) {
+        for (Lit l : this->trail) this->best_phase[Literal::var(l)] = Literal::sign(l) ? -1 : 1;
+        this->best_assigned = assigned;
+    }
+}
+
+/**
+ * Reset saved phases of all variables, cycling through original, best, inverted, best, random, best phases.
+ * Target phases start over from the new saved phases. Called at depth 0 so no assigned value overwrites the new phases.
+ */
+void Solver::rephase() {
+    static const char schedule[] = {'O', 'B', 'I', 'B', 'R', 'B'};
+    char mode = schedule[this->rephase_count % 6];
+    this->rephase_count++;
+    this->next_rephase = this->total_conflict_count + (long long) this->rephase_interval * (this->rephase_count + 1);
+    for (Var v = 0; v < this->var_count; v++) {
+        switch (mode) {
+            case 'O': this->saved_phase[v] = this->original_phase[v]; break;
+            case 'I': this->saved_phase[v] = -this->original_phase[v]; break;
+            case 'R': this->saved_phase[v] = (this->random_generator() & 1) ? 1 : -1; break;
+            case 'B': if (this->best_phase[v] != 0) this->saved_phase[v] = this->best_phase[v]; break;
+        }
+        this->target_phase[v] = 0;
     }
+    if (mode == 'B') this->best_assigned = 0;
+    this->target_assigned = 0;
+    if (this->check_restart_process) std::cout << "rephase " << mode << "\n";
 }
 
-void Literal::deleteLiteral() {
+/**
+ * Creat a learned clause in the arena and set its watched literals, its LBD is the one computed by learnCut().
+ * Learned clauses are not added to the occurrence lists, which only serve preprocessing and branching on original clauses.
+ * @param c learned clause in form of vector of literals
+ * @return reference to the new clause
+ */
+CRef Solver::setNewLearnedClause(std::vector<Lit>& c) {
+    CRef cr = this->arena.alloc(c, true);
+    this->list.push_back(cr);
+    this->learned_list.push_back(cr);
+    Clause& clause = this->arena[cr];
+    clause.lbd = this->learned_clause_lbd;
+    clause.activity = static_cast<float>(this->cla_inc);
+    this->setWatchedLiterals(clause);
+    return cr;
+}
+
+/**
+ * Called for every clause taking part in conflict analysis. Learned clauses get more activity, are marked used
+ * and get their LBD recomputed, which can move them to a better tier.
+ */
+void Solver::bumpClauseActivity(CRef cr) {
+    Clause& c = this->arena[cr];
+    if (!c.learned) return;
+    c.used = true;
+    c.activity += static_cast<float>(this->cla_inc);
+    if (c.activity > 1e20) {
+        for (CRef learned : this->learned_list) this->arena[learned].activity *= 1e-20;
+        this->cla_inc *= 1e-20;
+    }
+    if (c.lbd > static_cast<uint32_t>(this->core_lbd)) {
+        int lbd = this->computeLBD(c.begin(), c.end());
+        if (lbd < static_cast<int>(c.lbd)) c.lbd = lbd;
+    }
+}
+
+void Solver::decayClauseActivities() {
+    this->cla_inc /= this->cla_decay;
+}
+
+/**
+ * Increase the variable's activity by the current increment and move it up in the heap.
+ * All activities are scaled down together before they overflow, the order stays the same.
+ */
+void Solver::bumpActivity(Var v) {
+    this->activity[v] += this->var_inc;
+    if (this->activity[v] > 1e100) {
+        for (double& a : this->activity) a *= 1e-100;
+        this->var_inc *= 1e-100;
+    }
+    this->order_heap.increase(v);
+}
+
+/**
+ * Append a variable at the most recent end of the VMTF queue with a new timestamp.
+ */
+void Solver::enqueueVMTF(Var v) {
+    this->vmtf_prev[v] = this->vmtf_last;
+    this->vmtf_next[v] = Var_Undef;
+    if (this->vmtf_last != Var_Undef) this->vmtf_next[this->vmtf_last] = v;
+    else this->vmtf_first = v;
+    this->vmtf_last = v;
+    this->vmtf_stamp[v] = ++this->vmtf_stamp_count;
+}
+
+void Solver::dequeueVMTF(Var v) {
+    Var prev = this->vmtf_prev[v];
+    Var next = this->vmtf_next[v];
+    if (prev != Var_Undef) this->vmtf_next[prev] = next;
+    else this->vmtf_first = next;
+    if (next != Var_Undef) this->vmtf_prev[next] = prev;
+    else this->vmtf_last = prev;
+}
+
+/**
+ * Move the variables seen by conflict analysis to the front of the VMTF queue, keeping their relative order.
+ * The search pointer moves to the last free one, all variables behind it stay assigned.
+ * @param vars Variables seen by conflict analysis
+ */
+void Solver::bumpVMTF(const std::vector<Var>& vars) {
+    std::vector<Var> bumped(vars.begin(), vars.end());
+    std::sort(bumped.begin(), bumped.end(), [this](Var v1, Var v2) {return this->vmtf_stamp[v1] < this->vmtf_stamp[v2];});
+    for (Var v : bumped) {
+        if (v == this->vmtf_last) {
+            this->vmtf_stamp[v] = ++this->vmtf_stamp_count;
+            if (this->isFree(v)) this->vmtf_search = v;
+            continue;
+        }
+        if (v == this->vmtf_search) this->vmtf_search = this->vmtf_prev[v] != Var_Undef ? this->vmtf_prev[v] : this->vmtf_next[v];
+        this->dequeueVMTF(v);
+        this->enqueueVMTF(v);
+        if (this->isFree(v)) this->vmtf_search = v;
+    }
+}
+
+/**
+ * Decay all activities after a conflict by growing the increment, older bumps weigh less without touching every variable.
+ */
+void Solver::decayActivities() {
+    this->var_inc /= this->var_decay;
 }
 
 /**
  * Disconnect the clause from data structure, except original clause_count
+ * Memory stays in the arena as wasted until the next garbage collection.
  */
-void Clause::deleteClause() {
+void Solver::deleteClause(Clause& clause) {
+    CRef cr = this->arena.ref(clause);
     // Update literals
-    for (Literal* l : this->pos_literals_list) {
-        l->pos_occ.erase(this);
-        if (this->watched_literal_1 == l || this->watched_literal_2 == l) {
-            l->pos_watched_occ.erase(this);
+    for (uint32_t i = 0; i < clause.size; i++) {
+        Lit l = clause.literals[i];
+        std::vector<CRef>& occ = this->occ[l];
+        auto it = std::find(occ.begin(), occ.end(), cr);
+        if (it != occ.end()) {
+            *it = occ.back();
+            occ.pop_back();
         }
-        if (this == l->reason) l->reason = nullptr;
-    }
-    for (Literal* l : this->neg_literals_list) {
-        l->neg_occ.erase(this);
-        if (this->watched_literal_1 == l || this->watched_literal_2 == l) {
-            l->neg_watched_occ.erase(this);
+        if (i < 2 && clause.size >= 2) {
+            std::vector<Watcher>& watches = this->watched_occ[l];
+            auto w = std::find_if(watches.begin(), watches.end(), [cr](const Watcher& w) {return w.clause == cr;});
+            if (w != watches.end()) {
+                *w = watches.back();
+                watches.pop_back();
+            }
         }
-        if (this == l->reason) l->reason = nullptr;
+        if (cr == this->reason[Literal::var(l)].clause) this->reason[Literal::var(l)] = {};
     }
-    this->SAT = true;
-    if (Clause::conflict_clause == this) Clause::conflict_clause = nullptr;
-    Clause::list.erase(this);
+    clause.deleted = true;
+    if (this->conflict_clause == cr) this->conflict_clause = CRef_Undef;
+    this->arena.free(cr);
 }
 
 /**
- * Disconnect the clause from data structure, except original clause_count
+ * A clause is locked while it is the reason of its first literal, the literal propagated by it. Locked clauses are never deleted.
  */
-void LearnedClause::deleteLearnedClause() {
-    this->deleteClause();
-    LearnedClause::learned_list.erase(this);
+bool Solver::isLocked(Clause& clause) {
+    Lit first = clause.literals[0];
+    return this->isTrue(first) && this->reason[Literal::var(first)].clause == this->arena.ref(clause);
 }
 
-void LearnedClause::setDeletionStrategyValue() {
-    // TODO: change k and m base on var_count and clause_count
+/**
+ * Called after every conflict, reduces the learned clauses when the schedule is due.
+ * With the "lbd" policy core clauses and used tier2 clauses are kept, the others are sorted from the highest LBD and lowest activity
+ * and the worse half is deleted, except locked clauses.
+ * With the "activity" policy all learned clauses are candidates and only activity counts, "none" keeps every learned clause.
+ * Deleted clauses are only flagged, their watchers are removed in one sweep over the watched lists.
+ */
+void Solver::reduceDB() {
+    if (this->total_conflict_count < this->next_reduce || this->deletion_policy == "none") return;
+    bool by_lbd = this->deletion_policy == "lbd";
+    this->reduce_count++;
+    this->next_reduce = this->total_conflict_count + this->reduce_interval
+                                 + (long long) this->reduce_increment * this->reduce_count;
+
+    std::vector<CRef> candidates;
+    for (CRef cr : this->learned_list) {
+        Clause& c = this->arena[cr];
+        if (by_lbd && c.lbd <= static_cast<uint32_t>(this->core_lbd)) continue;
+        if (by_lbd && c.lbd <= static_cast<uint32_t>(this->tier2_lbd) && c.used) {
+            c.used = false;
+            continue;
+        }
+        c.used = false;
+        candidates.push_back(cr);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this, by_lbd](CRef cr1, CRef cr2) {
+        Clause& c1 = this->arena[cr1];
+        Clause& c2 = this->arena[cr2];
+        if (by_lbd && c1.lbd != c2.lbd) return c1.lbd > c2.lbd;
+        return c1.activity < c2.activity;
+    });
+    size_t deleted_count = 0;
+    for (size_t i = 0; i < candidates.size() / 2; i++) {
+        Clause& c = this->arena[candidates[i]];
+        if (this->isLocked(c)) continue;
+        c.deleted = true;
+        this->arena.free(candidates[i]);
+        deleted_count++;
+    }
+    if (deleted_count == 0) return;
+
+    for (std::vector<Watcher>& watches : this->watched_occ) {
+        watches.erase(std::remove_if(watches.begin(), watches.end(), [this](const Watcher& w) {
+            return !w.isBinary() && this->arena[w.clause].deleted;
+        }), watches.end());
+    }
+    size_t j = 0;
+    for (CRef cr : this->learned_list) {
+        if (!this->arena[cr].deleted) this->learned_list[j++] = cr;
+    }
+    this->learned_list.resize(j);
+    if (this->check_delete_process) std::cout << "Deleted " << deleted_count << " learned clauses, kept " << j << "\n";
+    if (this->arena.wasted > this->arena.size() / 2) this->collectGarbage();
 }
 
 /**
- * Out of bound learned clauses got deleted after m literals in the clause are unassigned
+ * Compact the arena by moving all clauses which are not deleted to a new arena.
+ * Every CRef held by list, learned_list, occurrence lists and reasons is updated to the new location.
  */
-void LearnedClause::checkDeletion() {
-    std::unordered_set<LearnedClause*> deleted_clauses;
-    for (LearnedClause* c : LearnedClause::learned_list) {
-        if (c->getWidth() > LearnedClause::k_bounded_learning && c->getUnsetLiteralsCount() > LearnedClause::m_size_relevance_based_learning) {
-            deleted_clauses.insert(c);
+void Solver::collectGarbage() {
+    ClauseArena to;
+    to.memory.reserve(this->arena.size() - this->arena.wasted);
+    for (Lit l = 0; l < this->occ.size(); l++) {
+        for (CRef& cr : this->occ[l]) cr = this->arena.relocate(cr, to);
+        for (Watcher& w : this->watched_occ[l]) {
+            if (!w.isBinary()) w.clause = this->arena.relocate(w.clause, to);
         }
     }
-    if (!deleted_clauses.empty()) {
-        for (LearnedClause* c : deleted_clauses) {
-            c->deleteLearnedClause();
-            delete c;
+    for (Reason& r : this->reason) {
+        if (r.clause != CRef_Undef) {
+            if (this->arena[r.clause].deleted) r = {};
+            else r.clause = this->arena.relocate(r.clause, to);
         }
-        if (Printer::check_delete_process) std::cout << "Delete success" << "\n";
     }
+    size_t j = 0;
+    for (CRef cr : this->list) {
+        if (!this->arena[cr].deleted) this->list[j++] = this->arena.relocate(cr, to);
+    }
+    this->list.resize(j);
+    for (CRef& cr : this->learned_list) cr = this->arena.relocate(cr, to);
+    if (this->check_delete_process) std::cout << "Arena compacted from " << this->arena.size() << " to " << to.size() << " words" << "\n";
+    this->arena = std::move(to);
+}
+
+/**
+ * Finite Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ...
+ * @param i Index starting at 0
+ * @return i-th element
+ */
+double Solver::luby(int i) {
+    // find the finite subsequence containing i and its size
+    int size = 1;
+    int seq = 0;
+    while (size < i + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) >> 1;
+        seq--;
+        i = i % size;
+    }
+    return 1 << seq;
+}
 
+/**
+ * Update moving averages after each learned clause, called before backtracking while the trail is complete.
+ * Averages start as plain means so early values are not biased towards 0.
+ * For glucose policy, a restart is blocked by resetting the conflict counter when the trail is much longer than average.
+ * @param lbd LBD of the learned clause
+ * @param trail_size Number of assigned literals at the conflict
+ */
+void Solver::updateRestartData(int lbd, int trail_size) {
+    auto n = static_cast<double>(this->total_conflict_count);
+    this->lbd_ema_fast += std::max(1.0 / 32, 1.0 / n) * (lbd - this->lbd_ema_fast);
+    this->lbd_ema_slow += std::max(1.0 / 4096, 1.0 / n) * (lbd - this->lbd_ema_slow);
+    if (this->restart_policy == "glucose" && this->total_conflict_count > 10000 && this->conflict_count > 0
+        && trail_size > this->blocking_margin * this->trail_ema) {
+        this->conflict_count = 0;
+        if (this->check_restart_process) std::cout << "restart blocked" << "\n";
+    }
+    this->trail_ema += std::max(1.0 / 5000, 1.0 / n) * (trail_size - this->trail_ema);
 }
 
 /**
- * Restart by empty unit queue and assignment stack, reset some counter and static variables.
+ * Check the restart condition of the chosen restart policy, called after backtracking.
+ * @return true if restart is due
  */
-void Formula::restart() {
-    while (!Literal::unit_queue.empty()) {
-        Literal::unit_queue.front()->reason = nullptr;
-        Literal::unit_queue.pop();
+bool Solver::shouldRestart() {
+    if (this->restart_policy == "glucose") {
+        return this->conflict_count >= 50 && this->lbd_ema_fast > this->restart_margin * this->lbd_ema_slow;
     }
-    Literal::bd2BranLit.clear();
+    return this->conflict_count >= this->conflict_count_limit;
+}
+
+/**
+ * Restart by empty unit queue and trail, reset some counter and static variables.
+ * The conflict limit of the next restart is set according to the restart policy.
+ */
+void Solver::restart() {
     // Except assignment depth 0 from preprocessing, undo all
-    while (!Assignment::stack.empty() && Assignment::stack.top()->assigned_literal->branching_level > 0) {
-        Assignment* top_assignment = Assignment::stack.top();
-        Literal::bd2BranLit.clear();
-        top_assignment->assigned_literal->unassignValueCDCL();
-        Assignment::stack.pop();
-        delete top_assignment;
-    }
-    Assignment::bd = 0;
-    Clause::CONFLICT = false;
-    Clause::conflict_clause = nullptr;
-    Formula::branching_count = 0;
-    Formula::conflict_count = 0;
-    Formula::conflict_count_limit = Formula::conflict_count_limit * 1.5;
-    Printer::solution.clear();
-
-    if (Printer::check_restart_process) std::cout << "restart success" << "\n";
+    this->cancelUntil(0);
+    this->branching_count = 0;
+    this->conflict_count = 0;
+    this->restart_count++;
+    if (this->restart_policy == "luby") {
+        this->conflict_count_limit = this->luby_unit * this->luby(this->restart_count);
+    } else {
+        this->conflict_count_limit = this->conflict_count_limit * 1.5;
+    }
+    if (this->rephase_interval > 0 && this->total_conflict_count >= this->next_rephase) this->rephase();
+
+    if (this->check_restart_process) std::cout << "restart success" << "\n";
 }
\ No newline at end of file
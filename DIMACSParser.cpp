@@ -0,0 +1,417 @@
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SATSolver.h"
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef HAVE_BZIP2
+#include <bzlib.h>
+#endif
+
+/**
+ * Cursor over DIMACS text in memory, counting lines for error messages.
+ * Integers are scanned by hand, no token string is ever built.
+ * The text is either one mapped range or a sequence of chunks handed out by "refill", tokens may span two chunks.
+ */
+struct DIMACSScanner {
+    const char* pos;
+    const char* end;
+    std::function<bool(const char*&, const char*&)> refill; // next chunk, false at the end of the input
+    int line = 1;
+
+    int peek() {
+        while (pos == end) {
+            if (!refill || !refill(pos, end)) return EOF;
+        }
+        return static_cast<unsigned char>(*pos);
+    }
+    static bool isBlank(int c) {return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';}
+    static bool isDigit(int c) {return c >= '0' && c <= '9';}
+
+    // skip blanks and line breaks
+    void skipSpace() {
+        for (int c = peek(); c == '\n' || isBlank(c); c = peek()) {
+            if (c == '\n') line++;
+            pos++;
+        }
+    }
+    // skip blanks inside the current line
+    void skipBlank() {
+        while (isBlank(peek())) pos++;
+    }
+    // skip to the line break, which is left to skipSpace() for counting
+    void skipLine() {
+        for (int c = peek(); c != EOF && c != '\n'; c = peek()) pos++;
+    }
+    bool readWord(const char* word) {
+        for (; *word != '\0'; word++, pos++) {
+            if (peek() != static_cast<unsigned char>(*word)) return false;
+        }
+        return true;
+    }
+    /**
+     * Scan a decimal integer ending at a blank, a line break or the end of the input.
+     * @param value Scanned integer
+     * @return false if there is no integer, it doesn't fit in int or it is followed by another character
+     */
+    bool readInt(int& value) {
+        bool negative = false;
+        if (peek() == '-') {
+            negative = true;
+            pos++;
+        }
+        if (!isDigit(peek())) return false;
+        long long magnitude = 0;
+        for (int c = peek(); isDigit(c); c = peek()) {
+            pos++;
+            magnitude = magnitude * 10 + (c - '0');
+            if (magnitude > INT_MAX) return false;
+        }
+        int c = peek();
+        if (c != EOF && c != '\n' && !isBlank(c)) return false;
+        value = negative ? -static_cast<int>(magnitude) : static_cast<int>(magnitude);
+        return true;
+    }
+};
+
+/**
+ * Bounded buffer between a decompression thread and the scanner.
+ * A fixed number of chunks circulates: the decompression thread fills free chunks, the scanner reads full ones in order
+ * and gives each back when it asks for the next, so the decompression thread waits once it is chunk_count chunks ahead.
+ */
+class ChunkPipe {
+public:
+    static constexpr size_t chunk_size = 1 << 20;
+    static constexpr int chunk_count = 4;
+    std::string error; // set by the decompression thread, read after it is joined
+
+    ChunkPipe() : chunks(chunk_count, std::vector<char>(chunk_size)), sizes(chunk_count, 0) {
+        for (int i = 0; i < chunk_count; i++) this->free_chunks.push(i);
+    }
+
+    /**
+     * Decompression thread: wait for a free chunk.
+     * @return index of the chunk, -1 if the scanner stopped reading
+     */
+    int acquire() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->changed.wait(lock, [this] {return this->cancelled || !this->free_chunks.empty();});
+        if (this->cancelled) return -1;
+        int chunk = this->free_chunks.front();
+        this->free_chunks.pop();
+        return chunk;
+    }
+    char* data(int chunk) {return this->chunks[chunk].data();}
+    /**
+     * Decompression thread: hand a filled chunk to the scanner.
+     */
+    void publish(int chunk, size_t size) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->sizes[chunk] = size;
+        this->full_chunks.push(chunk);
+        this->changed.notify_all();
+    }
+    /**
+     * Decompression thread: no more chunks will follow.
+     * @param message Error of the decompression, empty if the whole input was decompressed
+     */
+    void close(const std::string& message) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->error = message;
+        this->closed = true;
+        this->changed.notify_all();
+    }
+    /**
+     * Scanner: give back the chunk read so far and wait for the next full one.
+     * @return false once the input is exhausted
+     */
+    bool next(const char*& begin, const char*& end) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (this->reading >= 0) this->free_chunks.push(this->reading);
+        this->reading = -1;
+        this->changed.notify_all();
+        this->changed.wait(lock, [this] {return this->closed || !this->full_chunks.empty();});
+        if (this->full_chunks.empty()) return false;
+        this->reading = this->full_chunks.front();
+        this->full_chunks.pop();
+        begin = this->chunks[this->reading].data();
+        end = begin + this->sizes[this->reading];
+        return true;
+    }
+    /**
+     * Scanner: stop reading, a waiting decompression thread returns.
+     */
+    void cancel() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->cancelled = true;
+        this->changed.notify_all();
+    }
+
+private:
+    std::vector<std::vector<char>> chunks;
+    std::vector<size_t> sizes;
+    std::queue<int> free_chunks;
+    std::queue<int> full_chunks;
+    int reading = -1;
+    bool closed = false;
+    bool cancelled = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+#ifdef HAVE_ZLIB
+/**
+ * Decompress gzip (also concatenated members) into the pipe.
+ */
+void inflateGzip(const unsigned char* data, size_t size, ChunkPipe& pipe) {
+    z_stream stream{};
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) return pipe.close("gzip: initialization failed");
+    stream.next_in = const_cast<unsigned char*>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    std::string error;
+    int chunk;
+    while ((chunk = pipe.acquire()) >= 0) {
+        stream.next_out = reinterpret_cast<unsigned char*>(pipe.data(chunk));
+        stream.avail_out = ChunkPipe::chunk_size;
+        int status = inflate(&stream, Z_NO_FLUSH);
+        pipe.publish(chunk, ChunkPipe::chunk_size - stream.avail_out);
+        if (status == Z_STREAM_END && stream.avail_in > 0) {
+            inflateReset(&stream);
+        } else if (status == Z_STREAM_END) {
+            break;
+        } else if (status != Z_OK) {
+            error = std::string("gzip: ") + (stream.msg != nullptr ? stream.msg : "truncated input");
+            break;
+        }
+    }
+    inflateEnd(&stream);
+    pipe.close(error);
+}
+#endif
+
+#ifdef HAVE_LZMA
+/**
+ * Decompress xz (also concatenated streams) into the pipe.
+ */
+void inflateXZ(const unsigned char* data, size_t size, ChunkPipe& pipe) {
+    lzma_stream stream = LZMA_STREAM_INIT;
+    if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) return pipe.close("xz: initialization failed");
+    stream.next_in = data;
+    stream.avail_in = size;
+    std::string error;
+    int chunk;
+    while ((chunk = pipe.acquire()) >= 0) {
+        stream.next_out = reinterpret_cast<uint8_t*>(pipe.data(chunk));
+        stream.avail_out = ChunkPipe::chunk_size;
+        lzma_ret status = lzma_code(&stream, LZMA_FINISH);
+        pipe.publish(chunk, ChunkPipe::chunk_size - stream.avail_out);
+        if (status == LZMA_STREAM_END) break;
+        if (status != LZMA_OK) {
+            error = "xz: corrupted or truncated input (error " + std::to_string(status) + ")";
+            break;
+        }
+    }
+    lzma_end(&stream);
+    pipe.close(error);
+}
+#endif
+
+#ifdef HAVE_BZIP2
+/**
+ * Decompress bzip2 (also concatenated streams) into the pipe.
+ */
+void inflateBzip2(const unsigned char* data, size_t size, ChunkPipe& pipe) {
+    bz_stream stream{};
+    if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) return pipe.close("bzip2: initialization failed");
+    stream.next_in = const_cast<char*>(reinterpret_cast<const char*>(data));
+    stream.avail_in = static_cast<unsigned int>(size);
+    std::string error;
+    int chunk;
+    while ((chunk = pipe.acquire()) >= 0) {
+        stream.next_out = pipe.data(chunk);
+        stream.avail_out = ChunkPipe::chunk_size;
+        int status = BZ2_bzDecompress(&stream);
+        pipe.publish(chunk, ChunkPipe::chunk_size - stream.avail_out);
+        if (status == BZ_STREAM_END && stream.avail_in > 0) {
+            BZ2_bzDecompressEnd(&stream);
+            BZ2_bzDecompressInit(&stream, 0, 0);
+        } else if (status == BZ_STREAM_END) {
+            break;
+        } else if (status != BZ_OK || (stream.avail_in == 0 && stream.avail_out > 0)) {
+            error = "bzip2: corrupted or truncated input (error " + std::to_string(status) + ")";
+            break;
+        }
+    }
+    BZ2_bzDecompressEnd(&stream);
+    pipe.close(error);
+}
+#endif
+
+/**
+ * Scan DIMACS CNF text and add every clause to the clause store as soon as its terminating 0 is read.
+ * Variable arrays are sized from the "p cnf" header, which has to come before the first clause.
+ * A literal over the declared number of variables is an error, a different number of clauses only a warning.
+ * A "%" line (SATLIB files) ends the input.
+ * @param scanner Cursor at the start of the text
+ * @param path Name of the input, for messages
+ * @return false on a syntax error, printed with its line number
+ */
+bool Solver::parseDIMACS(DIMACSScanner& scanner, const std::string& path) {
+    auto error = [&](const std::string& message) {
+        std::cerr << path << ":" << scanner.line << ": " << message << std::endl;
+        return false;
+    };
+    bool header_read = false;
+    int declared_clauses = 0;
+    int read_clauses = 0;
+    std::vector<Lit> clause_literals;
+    while (true) {
+        scanner.skipSpace();
+        int c = scanner.peek();
+        if (c == EOF || c == '%') break;
+        if (c == 'c') {
+            scanner.skipLine();
+            continue;
+        }
+        if (c == 'p') {
+            if (header_read) return error("duplicated \"p cnf\" header");
+            scanner.pos++;
+            scanner.skipBlank();
+            if (!scanner.readWord("cnf") || !DIMACSScanner::isBlank(scanner.peek())) return error("only \"p cnf\" headers are supported");
+            int var_count;
+            scanner.skipBlank();
+            if (!scanner.readInt(var_count) || var_count < 0) return error("invalid number of variables in the header");
+            scanner.skipBlank();
+            if (!scanner.readInt(declared_clauses) || declared_clauses < 0) return error("invalid number of clauses in the header");
+            scanner.skipBlank();
+            if (scanner.peek() != '\n' && scanner.peek() != EOF) return error("unexpected text after the header");
+            // all variable arrays are sized once from the header
+            this->init(var_count);
+            this->var_count = var_count;
+            this->clause_count = declared_clauses;
+            header_read = true;
+            continue;
+        }
+        if (!header_read) return error("clause before the \"p cnf\" header");
+        int l;
+        if (!scanner.readInt(l)) return error(std::string("unexpected character '") + static_cast<char>(c) + "'");
+        if (l == 0) {
+            if (this->print_formula) {
+                for (Lit literal : clause_literals) std::cout << Literal::toDIMACS(literal) << " ";
+                std::cout << "\n";
+            }
+            this->setNewClause(clause_literals);
+            clause_literals.clear();
+            read_clauses++;
+        } else if (l > this->var_count || -l > this->var_count) {
+            return error("literal " + std::to_string(l) + " exceeds the " + std::to_string(this->var_count) + " declared variables");
+        } else {
+            clause_literals.push_back(Literal::fromDIMACS(l));
+        }
+    }
+    if (!header_read) return error("missing \"p cnf\" header");
+    if (!clause_literals.empty()) {
+        if (this->verbosity >= 1) std::cerr << path << ":" << scanner.line << ": last clause is not terminated by 0" << std::endl;
+        this->setNewClause(clause_literals);
+        read_clauses++;
+    }
+    if (read_clauses != declared_clauses && this->verbosity >= 1) {
+        std::cerr << path << ": header declares " << declared_clauses << " clauses, " << read_clauses << " were read" << std::endl;
+    }
+    return true;
+}
+
+/**
+ * Read a DIMACS file straight into the solver: the file is memory-mapped and scanned in place by parseDIMACS(),
+ * nothing is copied and no intermediate formula is built.
+ * gzip, xz and bzip2 files are recognized by their magic bytes, a thread decompresses the mapped file
+ * into a ChunkPipe that the scanner reads from, the decompressed text is never stored as a whole.
+ * @param path file's name or path to the file
+ * @return false if the file can't be read or isn't valid DIMACS, the reason is printed to cerr
+ */
+bool Solver::readDIMACS(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening file " << path << std::endl;
+        return false;
+    } else if (this->print_CDCL_process) {
+        std::cout << "File opened" << std::endl;
+    }
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        std::cerr << "File " << path << " is empty" << std::endl;
+        return false;
+    }
+    auto size = static_cast<size_t>(file_stat.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Error mapping file " << path << std::endl;
+        return false;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+    const char* text = static_cast<const char*>(data);
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    std::function<void(const unsigned char*, size_t, ChunkPipe&)> decompress;
+    std::string format;
+    if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+        format = "gzip";
+#ifdef HAVE_ZLIB
+        decompress = inflateGzip;
+#endif
+    } else if (size >= 6 && std::memcmp(bytes, "\xFD" "7zXZ\0", 6) == 0) {
+        format = "xz";
+#ifdef HAVE_LZMA
+        decompress = inflateXZ;
+#endif
+    } else if (size >= 3 && std::memcmp(bytes, "BZh", 3) == 0) {
+        format = "bzip2";
+#ifdef HAVE_BZIP2
+        decompress = inflateBzip2;
+#endif
+    }
+    bool parsed;
+    if (format.empty()) {
+        DIMACSScanner scanner{text, text + size, nullptr, 1};
+        parsed = this->parseDIMACS(scanner, path);
+    } else if (!decompress) {
+        std::cerr << "File " << path << " is compressed with " << format << ", which this build doesn't support" << std::endl;
+        parsed = false;
+    } else {
+        ChunkPipe pipe;
+        std::thread decompressor(decompress, bytes, size, std::ref(pipe));
+        DIMACSScanner scanner{nullptr, nullptr, [&pipe](const char*& begin, const char*& end) {return pipe.next(begin, end);}, 1};
+        parsed = this->parseDIMACS(scanner, path);
+        pipe.cancel();
+        decompressor.join();
+        if (!pipe.error.empty()) {
+            std::cerr << path << ": " << pipe.error << std::endl;
+            parsed = false;
+        }
+    }
+    munmap(data, size);
+
+    if (this->print_CDCL_process) std::cout << "Finished read file " << path << std::endl;
+    if (this->print_parsing_result) {
+        std::cout << "Number of variables: " << this->var_count << "\n";
+        std::cout << "Number of clauses: " << this->list.size() << "\n";
+        this->printAllData();
+        std::cout << "Finish parsing" << "\n";
+    }
+    return parsed;
+}
@@ -0,0 +1,641 @@
+#include <iostream>
+#include <algorithm>
+#include <queue>
+#include "SATSolver.h"
+
+/**
+ * Bounded variable elimination. Variables are tried in order of the number of clause pairs to resolve,
+ * a variable is eliminated if its resolvents have no more clauses and no more literals than its clauses and none is longer than
+ * this->elimination_resolvent_limit. Variables sharing clauses with an eliminated one are tried again.
+ * Runs at depth 0 after the other preprocessing, resolution work is bounded by this->elimination_effort per literal of the formula.
+ */
+void Solver::eliminateVariables() {
+    this->unitPropagationCDCL();
+    if (this->CONFLICT) {
+        this->isUNSAT = true;
+        return;
+    }
+    this->elimination_budget = this->elimination_effort * this->countLiterals();
+    auto cost = [this](Var v) {
+        return static_cast<long long>(this->occurrenceCount(Literal::makeLit(v, false))) * this->occurrenceCount(Literal::makeLit(v, true));
+    };
+    using Candidate = std::pair<long long, Var>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> candidates;
+    std::vector<bool> queued(this->var_count, false);
+    for (Var v = 0; v < this->var_count; v++) {
+        if (!this->isFree(v) || this->eliminated[v]) continue;
+        candidates.emplace(cost(v), v);
+        queued[v] = true;
+    }
+    std::vector<Var> touched;
+    while (!candidates.empty() && !this->isUNSAT && this->elimination_budget > 0) {
+        auto [key, v] = candidates.top();
+        candidates.pop();
+        if (!this->isFree(v) || this->eliminated[v]) continue;
+        // the key is outdated once clauses of v are replaced by resolvents of its neighbours
+        long long current = cost(v);
+        if (current > key) {
+            candidates.emplace(current, v);
+            continue;
+        }
+        queued[v] = false;
+        // satisfied clauses are counted too, the bounds are checked again exactly
+        if (current > this->elimination_product_limit || this->occurrenceCount(Literal::makeLit(v, false)) > this->elimination_occurrence_limit
+            || this->occurrenceCount(Literal::makeLit(v, true)) > this->elimination_occurrence_limit) continue;
+        touched.clear();
+        if (!this->eliminateVariable(v, touched)) continue;
+        for (Var u : touched) {
+            if (queued[u] || !this->isFree(u) || this->eliminated[u]) continue;
+            candidates.emplace(cost(u), u);
+            queued[u] = true;
+        }
+    }
+    if (this->check_elimination) std::cout << "Eliminated " << this->eliminated_count << " variables" << "\n";
+}
+
+/**
+ * Size of the formula for the work bounds of preprocessing: literals of the clauses in the arena and of the binary clauses.
+ */
+long long Solver::countLiterals() {
+    long long count = 2 * static_cast<long long>(this->getBinaryClauses().size());
+    for (CRef cr : this->list) {
+        if (!this->arena[cr].deleted) count += this->arena[cr].size;
+    }
+    return count;
+}
+
+/**
+ * Replace all clauses of a variable by their resolvents, if the bounds allow it.
+ * With a gate defining the variable only resolvents of gate clauses with the other clauses are needed.
+ * @param x Free variable
+ * @param touched Variables of the removed clauses, filled if x is eliminated
+ * @return true if x is eliminated
+ */
+bool Solver::eliminateVariable(Var x, std::vector<Var>& touched) {
+    Lit pos_x = Literal::makeLit(x, false);
+    Lit neg_x = Literal::makeLit(x, true);
+    std::vector<std::vector<Lit>> pos_clauses;
+    std::vector<std::vector<Lit>> neg_clauses;
+    this->collectOccurrences(pos_x, pos_clauses);
+    this->collectOccurrences(neg_x, neg_clauses);
+    if (static_cast<long long>(pos_clauses.size() * neg_clauses.size()) > this->elimination_product_limit
+        || static_cast<int>(std::max(pos_clauses.size(), neg_clauses.size())) > this->elimination_occurrence_limit) return false;
+
+    std::vector<bool> pos_gate(pos_clauses.size(), false);
+    std::vector<bool> neg_gate(neg_clauses.size(), false);
+    bool gate = this->findGate(pos_x, pos_clauses, neg_clauses, pos_gate, neg_gate);
+    std::vector<std::vector<Lit>> resolvents;
+    std::vector<Lit> resolvent;
+    size_t clause_limit = pos_clauses.size() + neg_clauses.size();
+    size_t literal_limit = 0;
+    for (const auto* clauses : {&pos_clauses, &neg_clauses}) {
+        for (const std::vector<Lit>& c : *clauses) literal_limit += c.size();
+    }
+    for (size_t i = 0; i < pos_clauses.size(); i++) {
+        for (size_t j = 0; j < neg_clauses.size(); j++) {
+            if (gate && pos_gate[i] == neg_gate[j]) continue;
+            if (!this->resolve(pos_clauses[i], neg_clauses[j], x, resolvent)) continue;
+            if (static_cast<int>(resolvent.size()) > this->elimination_resolvent_limit || resolvents.size() == clause_limit
+                || resolvent.size() > literal_limit) return false;
+            literal_limit -= resolvent.size();
+            resolvents.push_back(resolvent);
+        }
+    }
+
+    // clauses of one polarity are enough for the model, the other polarity is the default value
+    bool store_pos = pos_clauses.size() <= neg_clauses.size();
+    Lit pivot = store_pos ? pos_x : neg_x;
+    for (const std::vector<Lit>& c : store_pos ? pos_clauses : neg_clauses) {
+        this->elimination_stack.push_back(pivot);
+        for (Lit l : c) {
+            if (l != pivot) this->elimination_stack.push_back(l);
+        }
+        this->elimination_stack.push_back(static_cast<Lit>(c.size()));
+    }
+    this->elimination_stack.push_back(Literal::neg(pivot));
+    this->elimination_stack.push_back(1);
+    for (const auto* clauses : {&pos_clauses, &neg_clauses}) {
+        for (const std::vector<Lit>& c : *clauses) {
+            for (Lit l : c) {
+                if (Literal::var(l) != x) touched.push_back(Literal::var(l));
+            }
+        }
+    }
+
+    // deleteClause() removes the clause from the occurrence list, iterate over copies
+    std::vector<CRef> old_clauses = this->occ[pos_x];
+    old_clauses.insert(old_clauses.end(), this->occ[neg_x].begin(), this->occ[neg_x].end());
+    for (CRef cr : old_clauses) {
+        this->deleteClause(this->arena[cr]);
+    }
+    for (Lit l : {pos_x, neg_x}) {
+        std::vector<Lit> others;
+        for (const Watcher& watcher : this->watched_occ[l]) {
+            if (watcher.isBinary()) others.push_back(watcher.blocker);
+        }
+        for (Lit other : others) this->deleteBinaryClause(l, other);
+    }
+    this->eliminated[x] = true;
+    this->eliminated_count++;
+    if (this->check_elimination) std::cout << "Literal " << x + 1 << " is eliminated" << "\n";
+
+    for (std::vector<Lit>& c : resolvents) {
+        // values forced by earlier resolvents can satisfy or shorten this one
+        this->addSimplifiedClause(c);
+        if (this->isUNSAT) return true;
+    }
+    this->unitPropagationCDCL();
+    if (this->CONFLICT) this->isUNSAT = true;
+    return true;
+}
+
+/**
+ * Number of clauses containing the literal: long clauses from the occurrence list, binary clauses from the watched list.
+ * @param l Literal
+ */
+int Solver::occurrenceCount(Lit l) {
+    int count = static_cast<int>(this->occ[l].size());
+    for (const Watcher& watcher : this->watched_occ[l]) {
+        if (watcher.isBinary()) count++;
+    }
+    return count;
+}
+
+/**
+ * Copy the clauses containing the literal which are not SAT at depth 0, without their false literals and sorted.
+ * @param l Literal
+ * @param clauses Copies
+ */
+void Solver::collectOccurrences(Lit l, std::vector<std::vector<Lit>>& clauses) {
+    for (CRef cr : this->occ[l]) {
+        Clause& c = this->arena[cr];
+        if (this->SAT(c)) continue;
+        std::vector<Lit> literals;
+        for (Lit m : c) {
+            if (!this->isFalse(m)) literals.push_back(m);
+        }
+        std::sort(literals.begin(), literals.end());
+        clauses.push_back(std::move(literals));
+    }
+    for (const Watcher& watcher : this->watched_occ[l]) {
+        if (!watcher.isBinary() || this->isTrue(watcher.blocker)) continue;
+        std::vector<Lit> literals = {l};
+        if (!this->isFalse(watcher.blocker)) literals.push_back(watcher.blocker);
+        std::sort(literals.begin(), literals.end());
+        clauses.push_back(std::move(literals));
+    }
+}
+
+/**
+ * Resolve two sorted clauses on a variable.
+ * @param c1 Clause containing the positive literal of x
+ * @param c2 Clause containing the negative literal of x
+ * @param x Variable resolved on
+ * @param resolvent Sorted resolvent
+ * @return false if the resolvent is a tautology
+ */
+bool Solver::resolve(const std::vector<Lit>& c1, const std::vector<Lit>& c2, Var x, std::vector<Lit>& resolvent) {
+    this->elimination_budget -= static_cast<long long>(c1.size() + c2.size());
+    resolvent.clear();
+    size_t i = 0;
+    size_t j = 0;
+    while (i < c1.size() || j < c2.size()) {
+        Lit l;
+        if (j == c2.size() || (i < c1.size() && c1[i] < c2[j])) {
+            l = c1[i++];
+        } else if (i == c1.size() || c2[j] < c1[i]) {
+            l = c2[j++];
+        } else {
+            l = c1[i++];
+            j++;
+        }
+        if (Literal::var(l) == x) continue;
+        // both literals of a variable are neighbours in sorted order
+        if (!resolvent.empty() && resolvent.back() == Literal::neg(l)) return false;
+        resolvent.push_back(l);
+    }
+    return true;
+}
+
+/**
+ * Find clauses defining x as a function of other variables: an AND gate of either polarity, a XOR or an if-then-else.
+ * The resolvents of two gate clauses, and those of two other clauses, are implied by the remaining resolvents.
+ * @param x Positive literal of the variable
+ * @param pos_clauses Sorted clauses containing x
+ * @param neg_clauses Sorted clauses containing the negation of x
+ * @param pos_gate Set for gate clauses of pos_clauses
+ * @param neg_gate Set for gate clauses of neg_clauses
+ * @return true if a gate is found
+ */
+bool Solver::findGate(Lit x, const std::vector<std::vector<Lit>>& pos_clauses, const std::vector<std::vector<Lit>>& neg_clauses,
+                      std::vector<bool>& pos_gate, std::vector<bool>& neg_gate) {
+    auto find = [](const std::vector<std::vector<Lit>>& clauses, std::vector<Lit> literals) {
+        std::sort(literals.begin(), literals.end());
+        for (size_t i = 0; i < clauses.size(); i++) {
+            if (clauses[i] == literals) return static_cast<int>(i);
+        }
+        return -1;
+    };
+
+    // lit = AND(a1, ..., ak): binary clauses (-lit, ai) and the clause (lit, -a1, ..., -ak)
+    auto find_and = [](Lit lit, const std::vector<std::vector<Lit>>& lit_clauses, const std::vector<std::vector<Lit>>& other_clauses,
+                       std::vector<bool>& lit_gate, std::vector<bool>& other_gate) {
+        std::unordered_map<Lit, size_t> implied;
+        for (size_t j = 0; j < other_clauses.size(); j++) {
+            const std::vector<Lit>& c = other_clauses[j];
+            if (c.size() == 2) implied[c[0] == Literal::neg(lit) ? c[1] : c[0]] = j;
+        }
+        for (size_t i = 0; i < lit_clauses.size(); i++) {
+            const std::vector<Lit>& c = lit_clauses[i];
+            if (c.size() < 2 || !std::all_of(c.begin(), c.end(), [&](Lit m) {return m == lit || implied.count(Literal::neg(m));})) continue;
+            lit_gate[i] = true;
+            for (Lit m : c) {
+                if (m != lit) other_gate[implied[Literal::neg(m)]] = true;
+            }
+            return true;
+        }
+        return false;
+    };
+    if (find_and(x, pos_clauses, neg_clauses, pos_gate, neg_gate)) return true;
+    if (find_and(Literal::neg(x), neg_clauses, pos_clauses, neg_gate, pos_gate)) return true;
+
+    // x = XOR(a, b): (x, a, b) (x, -a, -b) (-x, -a, b) (-x, a, -b)
+    for (size_t i = 0; i < pos_clauses.size(); i++) {
+        const std::vector<Lit>& c = pos_clauses[i];
+        if (c.size() != 3) continue;
+        Lit a = c[0] == x ? c[1] : c[0];
+        Lit b = c[2] == x ? c[1] : c[2];
+        int k1 = find(pos_clauses, {x, Literal::neg(a), Literal::neg(b)});
+        int k2 = find(neg_clauses, {Literal::neg(x), Literal::neg(a), b});
+        int k3 = find(neg_clauses, {Literal::neg(x), a, Literal::neg(b)});
+        if (k1 < 0 || k2 < 0 || k3 < 0) continue;
+        pos_gate[i] = pos_gate[k1] = true;
+        neg_gate[k2] = neg_gate[k3] = true;
+        return true;
+    }
+
+    // x = ITE(c, t, e): (-x, -c, t) (-x, c, e) (x, -c, -t) (x, c, -e)
+    for (size_t i = 0; i < neg_clauses.size(); i++) {
+        const std::vector<Lit>& c1 = neg_clauses[i];
+        if (c1.size() != 3) continue;
+        std::vector<Lit> rest;
+        for (Lit l : c1) {
+            if (l != Literal::neg(x)) rest.push_back(l);
+        }
+        for (int order = 0; order < 2; order++) {
+            Lit not_c = rest[order];
+            Lit t = rest[1 - order];
+            int k1 = find(pos_clauses, {x, not_c, Literal::neg(t)});
+            if (k1 < 0) continue;
+            for (size_t j = 0; j < neg_clauses.size(); j++) {
+                const std::vector<Lit>& c2 = neg_clauses[j];
+                if (j == i || c2.size() != 3 || std::find(c2.begin(), c2.end(), Literal::neg(not_c)) == c2.end()) continue;
+                Lit e = Lit_Undef;
+                for (Lit l : c2) {
+                    if (l != Literal::neg(x) && l != Literal::neg(not_c)) e = l;
+                }
+                int k2 = find(pos_clauses, {x, Literal::neg(not_c), Literal::neg(e)});
+                if (k2 < 0) continue;
+                neg_gate[i] = neg_gate[j] = true;
+                pos_gate[k1] = pos_gate[k2] = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Give values to the eliminated variables once all others have one, going back through the elimination stack.
+ * Each eliminated variable first gets its default value, it is flipped if a stored clause would be false otherwise.
+ * Resolvents are true in the model, so a flip never falsifies a clause of the other polarity.
+ */
+void Solver::extendModel() {
+    int i = static_cast<int>(this->elimination_stack.size()) - 1;
+    while (i > 0) {
+        int size = this->elimination_stack[i];
+        int begin = i - size;
+        bool satisfied = false;
+        for (int k = begin + 1; k < i && !satisfied; k++) {
+            satisfied = this->isTrue(this->elimination_stack[k]);
+        }
+        if (!satisfied) {
+            Lit pivot = this->elimination_stack[begin];
+            this->values[pivot] = 1;
+            this->values[Literal::neg(pivot)] = -1;
+        }
+        i = begin - 1;
+    }
+}
+
+/**
+ * Signature of a clause: one of 64 bits for every variable. If a clause subsumes or strengthens another one,
+ * its signature has no bit the other one lacks, so most pairs are ruled out without comparing literals.
+ * @param literals Clause
+ */
+uint64_t Solver::clauseSignature(const std::vector<Lit>& literals) {
+    uint64_t signature = 0;
+    for (Lit l : literals) signature |= uint64_t(1) << (Literal::var(l) & 63);
+    return signature;
+}
+
+/**
+ * Backward subsumption and self-subsuming resolution at depth 0, on the original clauses or on the learned clauses.
+ * Every binary clause and every clause of the kind, shortest first, is tried against the clauses of the kind containing its rarest variable.
+ * A clause containing all literals of the subsumer is deleted, a clause containing them with one literal negated loses that literal.
+ * Strengthened clauses are tried as subsumers again. The pass on the original clauses stops after this->subsumption_step_limit compared pairs,
+ * a pass on the learned clauses after this->subsumption_effort pairs per literal propagated since the last pass.
+ * @param learned true for the learned clauses, false for the original clauses
+ */
+void Solver::subsumeClauses(bool learned) {
+    std::vector<CRef> candidates;
+    std::vector<uint64_t> signatures;
+    std::vector<std::vector<int>>& candidate_occ = this->subsume_occ;
+    candidate_occ.resize(this->occ.size());
+    std::vector<Lit> used_literals; // literals with a non-empty candidate_occ list
+    std::vector<Lit> literals;
+    for (CRef cr : learned ? this->learned_list : this->list) {
+        Clause& c = this->arena[cr];
+        if (c.deleted || c.learned != learned || c.size < 3 || this->SAT(c)) continue;
+        for (Lit l : c) {
+            if (candidate_occ[l].empty()) used_literals.push_back(l);
+            candidate_occ[l].push_back(static_cast<int>(candidates.size()));
+        }
+        literals.assign(c.begin(), c.end());
+        signatures.push_back(clauseSignature(literals));
+        candidates.push_back(cr);
+    }
+    std::vector<int> order(candidates.size());
+    for (size_t k = 0; k < order.size(); k++) order[k] = static_cast<int>(k);
+    std::stable_sort(order.begin(), order.end(), [this, &candidates](int k1, int k2) {
+        return this->arena[candidates[k1]].size < this->arena[candidates[k2]].size;
+    });
+    std::vector<std::pair<Lit, Lit>> binary_clauses = this->getBinaryClauses();
+
+    long long steps = this->subsumption_step_limit;
+    if (learned) {
+        steps = static_cast<long long>(this->subsumption_effort * static_cast<double>(this->propagation_count - this->subsume_propagations));
+        this->subsume_propagations = this->propagation_count;
+    }
+    size_t next_binary = 0;
+    size_t next = 0;
+    std::vector<Lit> subsumer;
+    while ((next_binary < binary_clauses.size() || next < order.size()) && steps > 0 && !this->isUNSAT) {
+        int self = -1;
+        if (next_binary < binary_clauses.size()) {
+            subsumer = {binary_clauses[next_binary].first, binary_clauses[next_binary].second};
+            next_binary++;
+        } else {
+            self = order[next++];
+            Clause& c = this->arena[candidates[self]];
+            if (c.deleted) continue;
+            subsumer.assign(c.begin(), c.end());
+        }
+        uint64_t signature = clauseSignature(subsumer);
+        // every clause subsumed or strengthened by the subsumer contains each of its variables, the rarest one gives the fewest to compare
+        Lit rarest = *std::min_element(subsumer.begin(), subsumer.end(), [&candidate_occ](Lit l1, Lit l2) {
+            return candidate_occ[l1].size() + candidate_occ[Literal::neg(l1)].size()
+                   < candidate_occ[l2].size() + candidate_occ[Literal::neg(l2)].size();
+        });
+        for (Lit l : {rarest, Literal::neg(rarest)}) {
+            for (int k : candidate_occ[l]) {
+                if (k == self || (signature & ~signatures[k]) != 0) continue;
+                Clause& c = this->arena[candidates[k]];
+                if (c.deleted || c.size < subsumer.size()) continue;
+                steps--;
+                Lit flipped = Lit_Undef; // literal of the subsumer found negated in the clause
+                bool contained = true;
+                for (Lit m : subsumer) {
+                    if (std::find(c.begin(), c.end(), m) != c.end()) continue;
+                    if (flipped == Lit_Undef && std::find(c.begin(), c.end(), Literal::neg(m)) != c.end()) {
+                        flipped = m;
+                        continue;
+                    }
+                    contained = false;
+                    break;
+                }
+                if (!contained) continue;
+                if (flipped == Lit_Undef) {
+                    this->deleteClause(c);
+                    this->subsumed_count++;
+                    continue;
+                }
+                CRef strengthened = this->strengthenClause(candidates[k], Literal::neg(flipped), literals);
+                this->strengthened_count++;
+                if (literals.size() == 2) binary_clauses.emplace_back(literals[0], literals[1]);
+                if (strengthened == CRef_Undef) continue;
+                // occurrences of the removed literal are left behind, comparing the literals skips them
+                candidates[k] = strengthened;
+                signatures[k] = clauseSignature(literals);
+                order.push_back(k);
+            }
+        }
+    }
+    for (Lit l : used_literals) candidate_occ[l].clear();
+    if (learned) {
+        size_t j = 0;
+        for (CRef cr : this->learned_list) {
+            if (!this->arena[cr].deleted) this->learned_list[j++] = cr;
+        }
+        this->learned_list.resize(j);
+    }
+    if (this->check_delete_process) std::cout << "Subsumed " << this->subsumed_count << " clauses, strengthened " << this->strengthened_count << "\n";
+    if (this->arena.wasted > this->arena.size() / 2) this->collectGarbage();
+}
+
+/**
+ * Replace a clause by a copy without a literal and without the literals false at depth 0, a learned copy keeps LBD and activity.
+ * The copy is stored like any new clause: in the watched lists if binary, assigned at depth 0 if unit, and an empty copy makes the formula UNSAT.
+ * @param cr Clause, deleted by the call
+ * @param l Literal to remove
+ * @param literals Literals of the copy, empty if the clause is SAT at depth 0
+ * @return reference to the copy, CRef_Undef if it has less than 3 literals
+ */
+CRef Solver::strengthenClause(CRef cr, Lit l, std::vector<Lit>& literals) {
+    Clause& c = this->arena[cr];
+    bool learned = c.learned;
+    uint32_t lbd = c.lbd;
+    float activity = c.activity;
+    literals.clear();
+    for (Lit m : c) {
+        if (m != l) literals.push_back(m);
+    }
+    this->deleteClause(c);
+    CRef copy = this->addSimplifiedClause(literals, learned, static_cast<int>(lbd));
+    if (copy != CRef_Undef && learned) this->arena[copy].activity = activity;
+    return copy;
+}
+
+/**
+ * Failed literal probing at depth 0. Both literals of every variable in a binary clause are decided and propagated in turn.
+ * A literal whose propagation ends in a conflict is failed and its negation is assigned, literals implied by both values are assigned as well.
+ * Stops after this->probing_effort propagated literals per literal of the formula.
+ */
+void Solver::probeLiterals() {
+    this->unitPropagationCDCL();
+    if (this->CONFLICT) {
+        this->isUNSAT = true;
+        return;
+    }
+    // probing is not search, its conflicts and propagations must not move the restart, reduction and rephasing schedules
+    int saved_conflict_count = this->conflict_count;
+    long long saved_total_conflict_count = this->total_conflict_count;
+    long long saved_propagation_count = this->propagation_count;
+    long long propagation_limit = this->propagation_count + this->probing_effort * this->countLiterals();
+    std::vector<Var> implied_by(this->values.size(), Var_Undef); // variable whose positive literal implied the literal last
+    std::vector<Lit> common;
+    for (Var v = 0; v < this->var_count && !this->isUNSAT && this->propagation_count < propagation_limit; v++) {
+        if (!this->isFree(v) || this->eliminated[v]) continue;
+        Lit pos_v = Literal::makeLit(v, false);
+        Lit neg_v = Literal::makeLit(v, true);
+        // without binary clauses a single literal rarely implies anything
+        auto has_binary = [this](Lit l) {
+            return std::any_of(this->watched_occ[l].begin(), this->watched_occ[l].end(), [](const Watcher& w) {return w.isBinary();});
+        };
+        if (!has_binary(pos_v) && !has_binary(neg_v)) continue;
+        common.clear();
+        Lit failed = Lit_Undef;
+        for (Lit p : {pos_v, neg_v}) {
+            size_t start = this->trail.size();
+            if (this->decide(p)) {
+                for (size_t i = start + 1; i < this->trail.size(); i++) {
+                    Lit l = this->trail[i];
+                    if (p == pos_v) implied_by[l] = v;
+                    else if (implied_by[l] == v) common.push_back(l);
+                }
+            } else {
+                failed = p;
+            }
+            this->undoDecisions(0);
+            if (failed != Lit_Undef) break;
+        }
+        if (failed != Lit_Undef) {
+            this->failed_literal_count++;
+            if (this->check_elimination) std::cout << "Literal " << Literal::toDIMACS(failed) << " is failed" << "\n";
+            this->assignValueCDCL(Literal::neg(failed));
+        } else {
+            for (Lit l : common) {
+                if (this->isFree(Literal::var(l))) this->assignValueCDCL(l);
+            }
+        }
+        this->unitPropagationCDCL();
+        if (this->CONFLICT) this->isUNSAT = true;
+    }
+    this->conflict_count = saved_conflict_count;
+    this->total_conflict_count = saved_total_conflict_count;
+    this->propagation_count = saved_propagation_count;
+}
+
+/**
+ * Find equivalent literals as strongly connected components of the binary implication graph, a binary clause (a, b) gives the edges
+ * -a -> b and -b -> a. The variables of a component are replaced everywhere by the smallest literal of the component and count as eliminated.
+ * A component holding both literals of a variable makes the formula UNSAT. Runs at depth 0 before any clause is learned.
+ */
+void Solver::substituteEquivalences() {
+    this->unitPropagationCDCL();
+    if (this->CONFLICT) {
+        this->isUNSAT = true;
+        return;
+    }
+    auto active = [this](Lit l) {
+        Var v = Literal::var(l);
+        return this->isFree(v) && !this->eliminated[v];
+    };
+    // Tarjan's algorithm with an explicit depth-first search path, each step with its position in the watched list
+    size_t literal_count = this->values.size();
+    std::vector<int> index(literal_count, -1);
+    std::vector<int> lowlink(literal_count, 0);
+    std::vector<bool> on_stack(literal_count, false);
+    std::vector<Lit> stack;
+    std::vector<Lit> representative(literal_count);
+    for (Lit l = 0; l < literal_count; l++) representative[l] = l;
+    std::vector<std::pair<Lit, size_t>> path;
+    int counter = 0;
+    auto visit = [&](Lit l) {
+        index[l] = lowlink[l] = counter++;
+        stack.push_back(l);
+        on_stack[l] = true;
+        path.emplace_back(l, 0);
+    };
+    for (Lit root = 0; root < literal_count && !this->isUNSAT; root++) {
+        if (index[root] >= 0 || !active(root)) continue;
+        visit(root);
+        while (!path.empty() && !this->isUNSAT) {
+            Lit l = path.back().first;
+            size_t& next = path.back().second;
+            // l true makes the other literal of every binary clause with -l true
+            const std::vector<Watcher>& watches = this->watched_occ[Literal::neg(l)];
+            Lit child = Lit_Undef;
+            while (next < watches.size() && child == Lit_Undef) {
+                const Watcher& w = watches[next++];
+                if (!w.isBinary() || !active(w.blocker)) continue;
+                if (index[w.blocker] < 0) child = w.blocker;
+                else if (on_stack[w.blocker]) lowlink[l] = std::min(lowlink[l], index[w.blocker]);
+            }
+            if (child != Lit_Undef) {
+                visit(child);
+                continue;
+            }
+            path.pop_back();
+            if (!path.empty()) {
+                Lit parent = path.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[l]);
+            }
+            if (lowlink[l] != index[l]) continue;
+            // the component is on top of the stack with l lowest, searching from the top keeps the pass linear
+            auto begin = std::find(stack.rbegin(), stack.rend(), l).base() - 1;
+            Lit smallest = *std::min_element(begin, stack.end());
+            for (auto it = begin; it != stack.end(); it++) {
+                on_stack[*it] = false;
+                representative[*it] = smallest;
+            }
+            for (auto it = begin; it != stack.end(); it++) {
+                if (representative[Literal::neg(*it)] == smallest) this->isUNSAT = true;
+            }
+            stack.erase(begin, stack.end());
+        }
+    }
+    if (this->isUNSAT) return;
+
+    // the component of the negated literals has the negated smallest literal, so both literals of a variable get consistent replacements
+    std::vector<Var> substituted;
+    for (Var v = 0; v < this->var_count; v++) {
+        Lit pos_v = Literal::makeLit(v, false);
+        if (active(pos_v) && representative[pos_v] != pos_v) substituted.push_back(v);
+    }
+    if (substituted.empty()) return;
+
+    std::vector<Lit> literals;
+    size_t clause_count = this->list.size(); // replacements are appended to the list
+    for (size_t i = 0; i < clause_count && !this->isUNSAT; i++) {
+        Clause& c = this->arena[this->list[i]];
+        if (c.deleted || c.learned || c.size < 2) continue;
+        if (std::all_of(c.begin(), c.end(), [&representative](Lit l) {return representative[l] == l;})) continue;
+        literals.clear();
+        for (Lit l : c) literals.push_back(representative[l]);
+        this->deleteClause(c);
+        this->addSimplifiedClause(literals);
+    }
+    for (auto [l1, l2] : this->getBinaryClauses()) {
+        if (this->isUNSAT) break;
+        if (representative[l1] == l1 && representative[l2] == l2) continue;
+        this->deleteBinaryClause(l1, l2);
+        literals = {representative[l1], representative[l2]};
+        this->addSimplifiedClause(literals);
+    }
+    for (Var v : substituted) {
+        // v = r as the clauses (v, -r) and the default value -v on the elimination stack
+        Lit pos_v = Literal::makeLit(v, false);
+        this->elimination_stack.push_back(pos_v);
+        this->elimination_stack.push_back(Literal::neg(representative[pos_v]));
+        this->elimination_stack.push_back(2);
+        this->elimination_stack.push_back(Literal::neg(pos_v));
+        this->elimination_stack.push_back(1);
+        this->eliminated[v] = true;
+        this->eliminated_count++;
+        this->substituted_count++;
+        if (this->check_elimination) std::cout << "Literal " << v + 1 << " is replaced by " << Literal::toDIMACS(representative[pos_v]) << "\n";
+    }
+    this->unitPropagationCDCL();
+    if (this->CONFLICT) this->isUNSAT = true;
+}
@@ -4,96 +4,267 @@
 #include "SATSolver.h"
 
 /**
- * Find intersection between two unordered set of type T
- * @tparam T Any type
- * @param s1 First set
- * @param s2 Second set
- * @return Unordered set of elements which both inputted sets contain.
- */
-template<typename T>
-std::unordered_set<T> findIntersection(const std::unordered_set<T>& s1, const std::unordered_set<T>& s2) {
-    std::unordered_set<T> intersection;
-
-    for (const T& e : s1) {
-        if (s2.contains(e)) {
-            intersection.insert(e);
-        }
+ * Create an empty solver, variables and clauses are added by readDIMACS().
+ * @param options Settings of the search and of the output
+ */
+Solver::Solver(const SolverOptions& options) {
+    this->time_limit = options.time_limit;
+    this->interrupt = options.interrupt;
+    this->branching_heuristic = options.branching_heuristic;
+    this->restart_policy = options.restart_policy;
+    this->deletion_policy = options.deletion_policy;
+    this->minimization_mode = options.minimization_mode;
+    this->chrono_threshold = options.chrono_threshold;
+    this->initial_phase = options.initial_phase;
+    // target phases keep VMTF, which moves every conflict variable to the front, on the same stalled trail
+    this->use_target_phase = options.target_phase && options.branching_heuristic == "VSIDS";
+    this->rephase_interval = options.rephase_interval;
+    this->random_generator.seed(options.random_seed);
+    this->verbosity = options.verbosity;
+    this->check_delete_process = options.verbosity >= 2;
+    this->check_restart_process = options.verbosity >= 2;
+    this->print_process = options.verbosity >= 3;
+    this->print_CDCL_process = options.verbosity >= 3;
+    this->order_heap.activity = &this->activity;
+    this->shared_clauses = options.shared_clauses;
+    this->solver_index = options.solver_index;
+    this->incremental = options.incremental;
+    this->elimination = options.elimination;
+    this->probing = options.probing;
+    this->substitution = options.substitution;
+    this->shared_positions.resize(this->shared_clauses.size(), 0);
+}
+
+/**
+ * Size all per-variable and per-literal arrays for variables 0..var_count-1, existing data is kept.
+ * @param var_count Number of variables, taken from the "p cnf" header
+ */
+void Solver::init(int var_count) {
+    int old_count = static_cast<int>(this->reason.size());
+    if (var_count <= old_count) return;
+    this->values.resize(2 * var_count, 0);
+    this->occ.resize(2 * var_count);
+    this->watched_occ.resize(2 * var_count);
+    this->reason.resize(var_count);
+    this->branching_level.resize(var_count, -1);
+    this->activity.resize(var_count, 0);
+    this->eliminated.resize(var_count, false);
+    this->pure.resize(var_count, false);
+    this->seen.resize(var_count, 0);
+    this->lbd_stamp.resize(var_count + 1, 0);
+    this->saved_phase.resize(var_count, -1);
+    this->target_phase.resize(var_count, 0);
+    this->best_phase.resize(var_count, 0);
+    this->original_phase.resize(var_count, -1);
+    this->trail.reserve(var_count);
+    this->order_heap.indices.resize(var_count, -1);
+    this->vmtf_prev.resize(var_count, Var_Undef);
+    this->vmtf_next.resize(var_count, Var_Undef);
+    this->vmtf_stamp.resize(var_count, 0);
+    for (Var v = old_count; v < var_count; v++) {
+        this->order_heap.insert(v);
+        this->enqueueVMTF(v);
     }
-    return intersection;
+    this->vmtf_search = this->vmtf_last;
+    this->var_count = var_count;
 }
 
-void Literal::setFree() {
-    this->isFree = true;
+void VarOrderHeap::insert(Var v) {
+    if (this->contains(v)) return;
+    this->indices[v] = static_cast<int>(this->heap.size());
+    this->heap.push_back(v);
+    this->percolateUp(this->indices[v]);
 }
 
 /**
- * Counting all positive occurrence in UNSAT clauses with number of free literal less or equal w, by the time called. Must called under free literal condition.
- * Occurrences in SAT clauses will not be counted.
- * @param w  Maximal number of free literals of clauses in pos_occ. If bigger than actual number of clause's size. Simply count all.
- * @return  Number of occurrence
- */
-int Literal::getActualPosOcc(int w) {
-    int occ = 0;
-    for (auto c : this->pos_occ) {
-        if (!c->SAT && c->free_literals.size() <= w) {
-            occ++;
-        }
+ * Restore the heap order after the activity of v grew.
+ */
+void VarOrderHeap::increase(Var v) {
+    if (this->contains(v)) this->percolateUp(this->indices[v]);
+}
+
+/**
+ * Remove and return the variable with the highest activity.
+ */
+Var VarOrderHeap::removeMax() {
+    Var max = this->heap[0];
+    this->heap[0] = this->heap.back();
+    this->indices[this->heap[0]] = 0;
+    this->indices[max] = -1;
+    this->heap.pop_back();
+    if (this->heap.size() > 1) this->percolateDown(0);
+    return max;
+}
+
+void VarOrderHeap::percolateUp(int i) {
+    Var v = this->heap[i];
+    while (i > 0) {
+        int parent = (i - 1) >> 1;
+        if ((*this->activity)[this->heap[parent]] >= (*this->activity)[v]) break;
+        this->heap[i] = this->heap[parent];
+        this->indices[this->heap[i]] = i;
+        i = parent;
     }
-    return occ;
+    this->heap[i] = v;
+    this->indices[v] = i;
 }
+
+void VarOrderHeap::percolateDown(int i) {
+    Var v = this->heap[i];
+    int size = static_cast<int>(this->heap.size());
+    while (2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if (child + 1 < size && (*this->activity)[this->heap[child + 1]] > (*this->activity)[this->heap[child]]) child++;
+        if ((*this->activity)[this->heap[child]] <= (*this->activity)[v]) break;
+        this->heap[i] = this->heap[child];
+        this->indices[this->heap[i]] = i;
+        i = child;
+    }
+    this->heap[i] = v;
+    this->indices[v] = i;
+}
+
 /**
- * Counting all negtive occurrence in UNSAT clauses with number of free literal less or equal w, by the time called. Must called under free literal condition.
+ * Counting all occurrence of the literal in UNSAT clauses with number of free literal less or equal w, by the time called. Must called under free literal condition.
  * Occurrences in SAT clauses will not be counted.
- * @param w Maximal number of free literals of clauses in neg_occ. If bigger than actual number of clause's size. Simply count all.
+ * @param l Literal, positive or negative occurrences are chosen by its sign
+ * @param w Maximal number of free literals of clauses in occ. If bigger than actual number of clause's size. Simply count all.
  * @return Number of occurrence
  */
-int Literal::getActualNegOcc(int w) {
-    int occ = 0;
-    for (auto c : this->neg_occ) {
-        if (!c->SAT && c->free_literals.size() <= w) {
-            occ++;
+int Solver::getActualOcc(Lit l, int w) {
+    int count = 0;
+    for (CRef cr : this->occ[l]) {
+        Clause& c = this->arena[cr];
+        if (!this->SAT(c) && this->getUnsetLiteralsCount(c) <= w) {
+            count++;
         }
     }
-    return occ;
+    // binary clauses only live in the watched list
+    for (const Watcher& watcher : this->watched_occ[l]) {
+        if (watcher.isBinary() && !this->isTrue(watcher.blocker)) {
+            int unset_count = 1 + this->isFree(Literal::var(watcher.blocker));
+            if (unset_count <= w) count++;
+        }
+    }
+    return count;
 }
 
 /**
- * Print all data saved by this instances of class Literal.
+ * Print all data saved for a variable.
  */
-void Literal::printData() {
-    std::cout << "Literal " << this->id << " at " << this <<" -";
-    if (this->isFree) std::cout << " free";
+void Solver::printData(Var v) {
+    std::cout << "Literal " << v + 1 << " -";
+    if (this->isFree(v)) std::cout << " free";
     else std::cout << " assigned";
     std::cout << " - pos_occ:";
-    for (auto c : this->pos_occ) {
-        std::cout << " " << c->id << ",";
+    for (CRef cr : this->occ[Literal::makeLit(v, false)]) {
+        std::cout << " " << cr << ",";
     }
     std::cout << " - neg_occ:";
-    for (auto c : this->neg_occ) {
-        std::cout << " " << c->id << ",";
+    for (CRef cr : this->occ[Literal::makeLit(v, true)]) {
+        std::cout << " " << cr << ",";
     }
-    if (this->reason == nullptr) std::cout << " - satisfy no clause " << std::endl;
-    else std::cout << " - satisfy clause " << this->reason->id << std::endl;
+    const Reason& r = this->reason[v];
+    if (r.isNone()) std::cout << " - satisfy no clause " << std::endl;
+    else if (r.clause == CRef_Undef) std::cout << " - satisfy binary clause with " << Literal::toDIMACS(r.binary_literal) << std::endl;
+    else std::cout << " - satisfy clause " << r.clause << std::endl;
 }
 
 
 /**
- * Save literal to clause's positive and negative literal list accordingly, and also all to free literals list.
- *
- * @param literal Pointer to literal
- * @param is_pos_occ "true" if positive literal, "false" otherwise
+ * Copy literals to the end of the arena behind a fresh header.
+ * @param literals Literals of the new clause
+ * @param learned "true" for learned clauses
+ * @return Reference to the new clause
  */
-void Clause::appendLiteral(Literal* literal, bool is_pos_occ) {
-    if (is_pos_occ) {
-        this->pos_literals_list.insert(literal);
-    } else {
-        this->neg_literals_list.insert(literal);
-    }
-    // literal is free when initial parse, unless when parsing to new learned clause
-    if (literal->isFree) this->free_literals.insert(literal);
-    else {
-        if (literal->value == true && is_pos_occ) this->sat_by.insert(literal);
-        if (literal->value == false && !is_pos_occ) this->sat_by.insert(literal);
+CRef ClauseArena::alloc(const std::vector<Lit>& literals, bool learned) {
+    auto cr = static_cast<CRef>(this->memory.size());
+    this->memory.resize(this->memory.size() + sizeof(Clause) / sizeof(uint32_t) + literals.size());
+    Clause& c = (*this)[cr];
+    c.size = literals.size();
+    c.learned = learned;
+    c.deleted = false;
+    c.relocated = false;
+    c.used = false;
+    c.lbd = 0;
+    c.activity = 0;
+    std::copy(literals.begin(), literals.end(), c.literals);
+    return cr;
+}
+
+/**
+ * Mark memory of a deleted clause as wasted, it will be reclaimed by the next garbage collection.
+ */
+void ClauseArena::free(CRef cr) {
+    this->wasted += sizeof(Clause) / sizeof(uint32_t) + (*this)[cr].size;
+}
+
+/**
+ * Move a clause to another arena, leaving a forwarding reference behind so every holder of the old CRef gets the same new one.
+ * @param cr Reference in this arena
+ * @param to Arena the clause is moved to
+ * @return Reference in the new arena
+ */
+CRef ClauseArena::relocate(CRef cr, ClauseArena& to) {
+    Clause& c = (*this)[cr];
+    if (c.relocated) return c.literals[0];
+    std::vector<Lit> literals(c.begin(), c.end());
+    CRef new_cr = to.alloc(literals, c.learned);
+    to[new_cr].activity = c.activity;
+    to[new_cr].lbd = c.lbd;
+    to[new_cr].used = c.used;
+    c.relocated = true;
+    c.literals[0] = new_cr;
+    return new_cr;
+}
+
+void ClauseArena::clear() {
+    this->memory.clear();
+    this->wasted = 0;
+}
+
+/**
+ * Append a clause, only called by the solver owning the buffer.
+ * @param clause Literals, at most max_size
+ * @param lbd LBD of the clause when it was learned
+ */
+void ClauseExchange::publish(const std::vector<Lit>& clause, int lbd) {
+    uint64_t position = this->head.load(std::memory_order_relaxed);
+    Slot& slot = this->slots[position % capacity];
+    slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.size.store(static_cast<int>(clause.size()), std::memory_order_relaxed);
+    slot.lbd.store(lbd, std::memory_order_relaxed);
+    for (size_t i = 0; i < clause.size(); i++) slot.literals[i].store(clause[i], std::memory_order_relaxed);
+    slot.sequence.store(2 * position + 2, std::memory_order_release);
+    this->head.store(position + 1, std::memory_order_release);
+}
+
+/**
+ * Copy the next clause after position which is still in the buffer.
+ * @param position Number of clauses of the buffer already read by the caller, advanced past the returned one
+ * @param clause Literals of the clause
+ * @param lbd LBD of the clause
+ * @return false if there is no new clause
+ */
+bool ClauseExchange::read(uint64_t& position, std::vector<Lit>& clause, int& lbd) const {
+    while (true) {
+        uint64_t end = this->head.load(std::memory_order_acquire);
+        if (position >= end) return false;
+        if (end - position > capacity) position = end - capacity; // older clauses are overwritten already
+        const Slot& slot = this->slots[position % capacity];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == 2 * position + 2) {
+            clause.resize(slot.size.load(std::memory_order_relaxed));
+            for (size_t i = 0; i < clause.size(); i++) clause[i] = slot.literals[i].load(std::memory_order_relaxed);
+            lbd = slot.lbd.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                position++;
+                return true;
+            }
+        }
+        position++; // the writer went around the ring and is rewriting this slot
     }
 }
 
@@ -101,86 +272,147 @@ void Clause::appendLiteral(Literal* literal, bool is_pos_occ) {
  * Check if all clauses are SAT
  * @return true if all clauses are SAT, false otherwise.
  */
-bool Clause::checkAllClausesSAT() {
-    for (const auto& c : Clause::list) {
-        if (!c->SAT) {return false;}
+bool Solver::checkAllClausesSAT() {
+    for (CRef cr : this->list) {
+        Clause& c = this->arena[cr];
+        if (!c.deleted && !this->SAT(c)) {return false;}
+    }
+    for (auto [l1, l2] : this->getBinaryClauses()) {
+        if (!this->isTrue(l1) && !this->isTrue(l2)) {return false;}
     }
     return true;
 }
 
 /**
- * Get number of free literals in the clause.
+ * Get number of free literals in the clause, counted from the literals' values.
  * @return Number of free literals
  */
-int Clause::getUnsetLiteralsCount() const {return this->free_literals.size();}
+int Solver::getUnsetLiteralsCount(Clause& clause) {
+    int count = 0;
+    for (Lit l : clause) {
+        if (this->values[l] == 0) count++;
+    }
+    return count;
+}
 
-int Clause::getWidth() const {return this->pos_literals_list.size() + this->neg_literals_list.size();}
 /**
- * Print all data saved by this instances of class Clause.
+ * Check if a literal of the clause is true, derived from the literals' values.
+ * @return true if SAT, false otherwise
  */
-void Clause::printData() {
-    std::cout << "Clause " << this->id << " at " << this <<" -";
-    std::cout << " pos_literals:";
-    for (auto l : this->pos_literals_list) {
-        std::cout << " " << l->id << ",";
-    }
-    std::cout << " - neg_literals:";
-    for (auto l : this->neg_literals_list) {
-        std::cout << " -" << l->id << ",";
+bool Solver::SAT(Clause& clause) {
+    for (Lit l : clause) {
+        if (this->isTrue(l)) return true;
     }
-    std::cout << " - current unassigned literals:";
-    for (auto l : this->free_literals) {
-        std::cout << " " << l->id << ",";
-    }
-    if (this->SAT) {
-        std::cout << " - satisfy by:";
-        for (auto l : this->sat_by) {
-            std::cout << " " << l->id << ",";
+    return false;
+}
+
+int Clause::getWidth() const {return this->size;}
+
+/**
+ * Move the two literals to watch to the front of the clause and add the clause to their watched lists,
+ * each watcher using the other watched literal as blocker.
+ * Non-false literals are preferred, otherwise false literals with the highest branching level,
+ * so a learned clause watches its asserting literal and a literal of the assertion level.
+ * Unit clauses have nothing to watch and are handled by removeInitialUnitClauses() or learnCut().
+ */
+void Solver::setWatchedLiterals(Clause& clause) {
+    if (clause.size < 2) return;
+    auto rank = [this](Lit l) {
+        if (!this->isFalse(l)) return INT_MAX;
+        return this->branching_level[Literal::var(l)];
+    };
+    for (uint32_t i = 0; i < 2; i++) {
+        uint32_t best = i;
+        for (uint32_t k = i + 1; k < clause.size; k++) {
+            if (rank(clause.literals[k]) > rank(clause.literals[best])) best = k;
         }
-    } else std::cout << " - UNSAT" << std::endl;
+        std::swap(clause.literals[i], clause.literals[best]);
+    }
+    CRef cr = this->arena.ref(clause);
+    this->watched_occ[clause.literals[0]].push_back({cr, clause.literals[1]});
+    this->watched_occ[clause.literals[1]].push_back({cr, clause.literals[0]});
 }
 
 /**
- * Update number of literals, unordered map literal's id to adress and list of id.
+ * Remove the clause from the watched lists of its two watched literals, setWatchedLiterals() adds it again.
  */
-void Literal::updateStaticData() {
-    Literal::count++;
-    Literal::id2Lit[this->id] = this;
-    Literal::id_list.insert(id);
+void Solver::unwatch(Clause& clause) {
+    if (clause.size < 2) return;
+    CRef cr = this->arena.ref(clause);
+    for (uint32_t i = 0; i < 2; i++) {
+        std::vector<Watcher>& watches = this->watched_occ[clause.literals[i]];
+        auto w = std::find_if(watches.begin(), watches.end(), [cr](const Watcher& w) {return w.clause == cr;});
+        if (w != watches.end()) {
+            *w = watches.back();
+            watches.pop_back();
+        }
+    }
 }
 
 /**
- * Update number of clauses and list of clauses.
+ * Print all data saved by this instances of class Clause.
  */
-void Clause::updateStaticData() {
-    Clause::count++;
-    Clause::list.insert(this);
+void Solver::printData(Clause& clause) {
+    std::cout << "Clause " << this->arena.ref(clause) << " -";
+    std::cout << " literals:";
+    for (Lit l : clause) {
+        std::cout << " " << Literal::toDIMACS(l) << ",";
+    }
+    std::cout << " - watched: " << Literal::toDIMACS(clause.literals[0]);
+    if (clause.size >= 2) std::cout << ", " << Literal::toDIMACS(clause.literals[1]);
+    std::cout << " - current unassigned literals: " << this->getUnsetLiteralsCount(clause);
+    if (this->SAT(clause)) {
+        std::cout << " - SAT" << std::endl;
+    } else std::cout << " - UNSAT" << std::endl;
 }
 
-void Assignment::updateStaticData() {
-    stack.push(this);
+/**
+ * Start a new depth at the current end of the trail, the next assigned literal is its branching literal.
+ */
+void Solver::newBranchingLevel() {
+    this->level_start.push_back(static_cast<int>(this->trail.size()));
+    this->bd++;
 }
 
 /**
- * Print all assignment in the stack without changing the stack.
+ * Unassign all literals of depth > level by truncating the trail, literals left in the propagation queue are dropped as well.
+ * @param level Depth to keep
  */
-void Printer::printAssignmentStack() {
-    if (Assignment::enablePrintAll) {
-        std::stack<Assignment*> s = Assignment::stack;
-        std::stack<Assignment*> reversed_stack;
-        while (!s.empty()) {
-            reversed_stack.push(s.top());
-            s.pop();
+void Solver::cancelUntil(int level) {
+    if (this->bd <= level) return;
+    int keep = this->level_start[level];
+    // after chronological backtracking literals of lower depths can be above the cut, they stay assigned in the same order
+    size_t kept = keep;
+    for (size_t i = keep; i < this->trail.size(); i++) {
+        Lit l = this->trail[i];
+        if (this->branching_level[Literal::var(l)] > level) {
+            this->unassignValueCDCL(Literal::var(l));
+        } else {
+            this->trail[kept++] = l;
         }
-        Assignment::assignment_history.emplace_back(reversed_stack);
-        while (!reversed_stack.empty()) {
-            Literal* l = reversed_stack.top()->assigned_literal;
-            std::cout << "[" << l->id << "|" << l->value << "|";
-            if (reversed_stack.top()->status) {std::cout << "f]";}
-            else {std::cout << "b]";}
-            std::cout << "-";
-            reversed_stack.pop();
+    }
+    this->trail.resize(kept);
+    this->level_start.resize(level);
+    this->propagation_head = keep;
+    this->bd = level;
+    this->assumption_head = 0;
+}
+
+/**
+ * Print all assignment in the trail.
+ */
+void Solver::printAssignmentStack() {
+    if (this->enablePrintAll) {
+        std::vector<std::string> entries;
+        for (int i = 0; i < static_cast<int>(this->trail.size()); i++) {
+            Lit l = this->trail[i];
+            std::string a = "[" + std::to_string(Literal::var(l) + 1) + "|" + std::to_string(!Literal::sign(l)) + "|";
+            if (this->isBranching(i)) {a += "b]";}
+            else {a += "f]";}
+            std::cout << a << "-";
+            entries.push_back(a);
         }
+        this->assignment_history.push_back(entries);
         std::cout<<std::endl;
     }
 }
@@ -188,17 +420,11 @@ void Printer::printAssignmentStack() {
 /**
  * Print all assignments include removed ones by backtracking in graph form.
  */
-void Printer::printAssignmentHistory() {
+void Solver::printAssignmentHistory() {
     std::unordered_set<std::string> printed_list;
-    for (auto& s : Assignment::assignment_history) {
+    for (const auto& entries : this->assignment_history) {
         bool print_rest = false;
-        while (!s.empty()) {
-            // get first assignment
-            Literal* l = s.top()->assigned_literal;
-            std::string a = "[" + std::to_string(l->id) + "|" + std::to_string(l->value) + "|";
-            if (s.top()->status) { a += "f]";}
-            else {a += "b]";}
-
+        for (const std::string& a : entries) {
             if (print_rest || printed_list.count(a) == 0 ) {
                 if (print_rest && printed_list.count(a) != 0) {
                     printed_list.erase(a);
@@ -208,204 +434,388 @@ void Printer::printAssignmentHistory() {
             } else if (printed_list.count(a) >= 1) {
                 std::cout << "        ";
             }
-            s.pop();
         }
         std::cout << std::endl;
     }
 }
 /**
- * creat new variable or update data structure when creating a new clause with old variable
- * Both data structure Clause and Literal, the connection between both, are updated here
- * @param l id of the literal
- * @param new_clause point to the clause contain the literal
+ * convert a DIMACS literal and connect it to a new clause, growing the arrays if the variable is beyond the header's count
+ * @param l DIMACS id of the literal
+ * @param new_clause reference to the clause contain the literal, CRef_Undef for binary clauses which have no occurrence entry
+ * @return the literal
  */
-void Literal::setLiteral(int l, Clause* new_clause) {
-    if (Literal::id_list.count(abs(l)) == 0) { // id is not in the list (count = 0) meaning new Literal
-        auto* new_literal = new Literal(abs(l));
-        new_literal->updateStaticData();
-        if (l >= 0) {
-            // connecting literals and clauses
-            new_literal->pos_occ.insert(new_clause);
-            new_clause->appendLiteral(new_literal, true);
-        } else {
-            // connecting literals and clauses
-            new_literal->neg_occ.insert(new_clause);
-            new_clause->appendLiteral(new_literal, false);
+Lit Solver::setLiteral(int l, CRef new_clause) {
+    if (abs(l) > this->var_count) this->init(abs(l));
+    Lit literal = Literal::fromDIMACS(l);
+    // connecting literals and clauses
+    if (new_clause != CRef_Undef) this->occ[literal].push_back(new_clause);
+    return literal;
+}
+
+/**
+ * Visit only the clauses watching the literal false_literal, which just became false.
+ * A watcher whose blocker is true is skipped without reading the clause, binary clauses are handled inside the watcher.
+ * Other clauses either keep the watch (other watched literal is true and becomes the blocker), move it to a non-false literal,
+ * become unit (other watched literal is assigned by force with the clause as reason) or report a conflict.
+ * Clauses not watching the falsified literal are never touched, unassigning needs no update at all.
+ * @param false_literal Literal falsified by the latest assignment
+ */
+void Solver::updateWatchedClauses(Lit false_literal) {
+    std::vector<Watcher>& watches = this->watched_occ[false_literal];
+    size_t i = 0;
+    size_t j = 0;
+    while (i < watches.size()) {
+        Watcher watcher = watches[i++];
+        if (this->isTrue(watcher.blocker)) {
+            watches[j++] = watcher;
+            continue;
         }
-        // push to priority queue
-        Literal::pq.push(new_literal);
-    } else {
-        auto* updating_literal = Literal::id2Lit[abs(l)];
-        if (l >= 0) {
-            updating_literal->pos_occ.insert(new_clause);
-            new_clause->appendLiteral(updating_literal, true);
+        if (watcher.isBinary()) {
+            watches[j++] = watcher;
+            if (this->isFalse(watcher.blocker)) {
+                this->reportBinaryConflict(false_literal, watcher.blocker);
+                while (i < watches.size()) watches[j++] = watches[i++];
+            } else {
+                this->assignValueCDCL(watcher.blocker, Reason::binary(false_literal));
+            }
+            continue;
+        }
+        CRef cr = watcher.clause;
+        Clause& clause = this->arena[cr];
+        // keep the false watched literal at second position
+        if (clause.literals[0] == false_literal) std::swap(clause.literals[0], clause.literals[1]);
+        Lit other_watched = clause.literals[0];
+        if (other_watched != watcher.blocker && this->isTrue(other_watched)) {
+            watches[j++] = {cr, other_watched};
+            continue;
+        }
+        // find a new literal to watch, the clause then leaves this watched list
+        bool moved = false;
+        for (uint32_t k = 2; k < clause.size; k++) {
+            if (!this->isFalse(clause.literals[k])) {
+                std::swap(clause.literals[1], clause.literals[k]);
+                this->watched_occ[clause.literals[1]].push_back({cr, other_watched});
+                moved = true;
+                break;
+            }
+        }
+        if (moved) continue;
+        if (this->isFalse(other_watched)) {
+            // no free literals and clause UNSAT, report CONFLICT and keep the rest of the list
+            watches[j++] = {cr, other_watched};
+            this->reportConflict(clause);
+            while (i < watches.size()) watches[j++] = watches[i++];
+            continue;
+        }
+        // with chronological backtracking the forced literal takes the max depth of the false literals, that one is watched instead
+        uint32_t max_k = 1;
+        if (this->chrono_threshold >= 0) {
+            for (uint32_t k = 2; k < clause.size; k++) {
+                if (this->branching_level[Literal::var(clause.literals[k])] > this->branching_level[Literal::var(clause.literals[max_k])]) max_k = k;
+            }
+        }
+        if (max_k != 1) {
+            std::swap(clause.literals[1], clause.literals[max_k]);
+            this->watched_occ[clause.literals[1]].push_back({cr, other_watched});
         } else {
-            updating_literal->neg_occ.insert(new_clause);
-            new_clause->appendLiteral(updating_literal, false);
+            watches[j++] = {cr, other_watched};
         }
+        this->assignValueCDCL(other_watched, {cr, Lit_Undef});
     }
+    watches.resize(j);
 }
 
 /**
- * creat a new clause
+ * creat a new clause in the arena
  * update all data structures
- * @param c a new clause in form of vector of literal_id
+ * Duplicated literals are merged so the two watched literals are always different.
+ * A clause added while literals are assigned (resolvents of variable elimination) can be unit or conflicting right away.
+ * Binary clauses are only stored in the watched lists.
+ * @param c a new clause in form of vector of literals
+ * @return reference to the new clause, CRef_Undef for binary clauses
+ */
+CRef Solver::setNewClause(std::vector<Lit>& c) {
+    std::sort(c.begin(), c.end());
+    c.erase(std::unique(c.begin(), c.end()), c.end());
+    if (c.empty()) this->isUNSAT = true; // empty clause can never be satisfied
+    if (c.size() == 2) {
+        this->setNewBinaryClause(c[0], c[1]);
+        return CRef_Undef;
+    }
+    CRef cr = this->arena.alloc(c, false);
+    this->list.push_back(cr);
+    for (Lit l : c) {
+        this->occ[l].push_back(cr);
+    }
+    Clause& clause = this->arena[cr];
+    this->setWatchedLiterals(clause);
+    if (clause.size >= 2 && this->isFalse(clause.literals[1]) && !this->isTrue(clause.literals[0])) {
+        if (this->isFalse(clause.literals[0])) {
+            this->reportConflict(clause);
+        } else {
+            this->assignValueCDCL(clause.literals[0], {cr, Lit_Undef});
+        }
+    }
+    return cr;
+}
+
+/**
+ * Add a clause at depth 0, simplified by the values of depth 0: it is dropped if SAT or a tautology, duplicate and false literals are removed.
+ * An empty clause makes the formula UNSAT, a unit clause is assigned, a binary clause is only watched, longer ones are stored in the arena.
+ * Used for clauses added by the user, imported from other solvers and derived by preprocessing.
+ * @param c Literals, left sorted and simplified, emptied if the clause is dropped
+ * @param learned Store a long clause as learned clause
+ * @param lbd LBD of a learned clause, at most its size is kept
+ * @return reference to the stored clause, CRef_Undef if it isn't stored in the arena
+ */
+CRef Solver::addSimplifiedClause(std::vector<Lit>& c, bool learned, int lbd) {
+    std::sort(c.begin(), c.end());
+    c.erase(std::unique(c.begin(), c.end()), c.end());
+    size_t j = 0;
+    for (size_t i = 0; i < c.size(); i++) {
+        Lit l = c[i];
+        // sorted, so both literals of a variable are neighbours
+        if (this->isTrue(l) || (i + 1 < c.size() && c[i + 1] == Literal::neg(l))) {
+            c.clear();
+            return CRef_Undef;
+        }
+        if (!this->isFalse(l)) c[j++] = l;
+    }
+    c.resize(j);
+    if (c.empty()) {
+        this->isUNSAT = true;
+    } else if (c.size() == 1) {
+        this->assignValueCDCL(c[0]);
+    } else if (c.size() == 2) {
+        this->setNewBinaryClause(c[0], c[1]);
+    } else if (learned) {
+        this->learned_clause_lbd = std::min(lbd, static_cast<int>(c.size()));
+        return this->setNewLearnedClause(c);
+    } else {
+        return this->setNewClause(c);
+    }
+    return CRef_Undef;
+}
+
+/**
+ * Add a clause between solve() calls, values of the last call except depth 0 are undone so its model is lost.
+ * Duplicate literals are merged, a clause with both literals of a variable or true at depth 0 is dropped and false literals are removed,
+ * so the clause is unit, becomes a forced assignment, or is watched like any original clause.
+ * After the first solve() only an incremental solver takes clauses: otherwise preprocessing may have assigned pure literals
+ * and removed variables, which a new clause can contradict.
+ * @param literals Clause, variables beyond var_count are added
+ * @return false if the clause is refused
+ */
+bool Solver::addClause(std::vector<Lit> literals) {
+    if (this->preprocessed && !this->incremental) {
+        std::cerr << "Clauses can only be added after solve() by a solver with SolverOptions::incremental" << std::endl;
+        return false;
+    }
+    this->cancelUntil(0);
+    this->isSAT = false;
+    for (Lit l : literals) {
+        if (Literal::var(l) >= this->var_count) this->init(Literal::var(l) + 1);
+    }
+    this->clause_count++;
+    this->addSimplifiedClause(literals);
+    return true;
+}
+
+/**
+ * creat a binary clause without clause memory, each literal's watched list gets the other literal as implied blocker
+ * @param l1 first literal
+ * @param l2 second literal
+ */
+void Solver::setNewBinaryClause(Lit l1, Lit l2) {
+    this->watched_occ[l1].push_back({CRef_Undef, l2});
+    this->watched_occ[l2].push_back({CRef_Undef, l1});
+    // a binary clause added while literals are assigned can be unit or conflicting right away
+    for (auto [l, other] : {std::pair(l1, l2), std::pair(l2, l1)}) {
+        if (this->isFalse(l) && !this->isTrue(other)) {
+            if (this->isFalse(other)) {
+                this->reportBinaryConflict(l, other);
+            } else {
+                this->assignValueCDCL(other, Reason::binary(l));
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * Remove a binary clause by erasing its watcher from both watched lists.
+ */
+void Solver::deleteBinaryClause(Lit l1, Lit l2) {
+    for (auto [l, other] : {std::pair(l1, l2), std::pair(l2, l1)}) {
+        std::vector<Watcher>& watches = this->watched_occ[l];
+        for (size_t i = 0; i < watches.size(); i++) {
+            if (watches[i].isBinary() && watches[i].blocker == other) {
+                watches[i] = watches.back();
+                watches.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Collect all binary clauses from the watched lists, each clause once.
+ * @return pairs of literals
  */
-void Clause::setNewClause(std::vector<int>& c) {
-    auto* new_clause = new Clause(Clause::count);
-    new_clause->updateStaticData();
-    for (auto l : c) {
-        Literal::setLiteral(l, new_clause);
+std::vector<std::pair<Lit, Lit>> Solver::getBinaryClauses() {
+    std::vector<std::pair<Lit, Lit>> binary_clauses;
+    for (Lit l = 0; l < this->watched_occ.size(); l++) {
+        for (const Watcher& watcher : this->watched_occ[l]) {
+            if (watcher.isBinary() && l < watcher.blocker) binary_clauses.emplace_back(l, watcher.blocker);
+        }
     }
-    new_clause->setWatchedLiterals();
+    return binary_clauses;
 }
 
 /**
  * This heuristic choose clause with the smallest number of unassigned literals.
  * Value is chosen base on number of positive or negative occurrences.
- * @return A tuple of (pointer to chosen literal, value)
+ * @return A tuple of (chosen variable, value), Var_Undef if all variables are assigned
  */
-std::tuple<Literal*, bool> Heuristic::MOM() {
-    if (Printer::print_process) std::cout << "Using heuristic MOM" << "\n";
+std::tuple<Var, bool> Solver::MOM() {
+    if (this->print_process) std::cout << "Using heuristic MOM" << "\n";
 
-    Assignment::branching_heuristic = "MOM";
+    this->branching_heuristic = "MOM";
     // check all clauses for the shortest
-    Clause* shortest_clause = nullptr;
+    std::vector<Lit> shortest_literals;
     int shortest_width = INT_MAX;
-    for (auto c : Clause::list) {
-        int clause_actual_width = c->free_literals.size();
-        if (!c->SAT && clause_actual_width < shortest_width) {
+    for (CRef cr : this->list) {
+        Clause& c = this->arena[cr];
+        if (c.deleted || this->SAT(c)) continue;
+        int clause_actual_width = this->getUnsetLiteralsCount(c);
+        if (clause_actual_width < shortest_width) {
             shortest_width = clause_actual_width;
-            shortest_clause = c;
+            shortest_literals.assign(c.begin(), c.end());
+        }
+    }
+    for (auto [l1, l2] : this->getBinaryClauses()) {
+        if (this->isTrue(l1) || this->isTrue(l2)) continue;
+        int clause_actual_width = (this->values[l1] == 0) + (this->values[l2] == 0);
+        if (clause_actual_width < shortest_width) {
+            shortest_width = clause_actual_width;
+            shortest_literals = {l1, l2};
         }
     }
 
-    Literal* chosen_literal = nullptr;
+    Var chosen_variable = Var_Undef;
     int n = INT_MIN;
     bool value = true;
-    if (shortest_clause != nullptr) {
-        //choose literal using MOM formula with alpha = 1
-        for (auto l : shortest_clause->free_literals) {
-            int actual_pos_occ = l->getActualPosOcc(shortest_width); // get number occ of literal in clauses with the exact shortest_width
-            int actual_neg_occ = l->getActualNegOcc(shortest_width);
-            int v = (actual_pos_occ + actual_neg_occ) * 2 ^ 1 + actual_pos_occ * actual_neg_occ;
-            if (v > n) {
-                n = v;
-                chosen_literal = l;
-                value = (actual_pos_occ >= actual_neg_occ) ? true : false;
-            }
+    //choose literal using MOM formula with alpha = 1
+    for (Lit l : shortest_literals) {
+        Var v = Literal::var(l);
+        if (!this->isFree(v)) continue;
+        int actual_pos_occ = this->getActualOcc(Literal::makeLit(v, false), shortest_width); // get number occ of literal in clauses with the exact shortest_width
+        int actual_neg_occ = this->getActualOcc(Literal::makeLit(v, true), shortest_width);
+        int score = (actual_pos_occ + actual_neg_occ) * 2 ^ 1 + actual_pos_occ * actual_neg_occ;
+        if (score > n) {
+            n = score;
+            chosen_variable = v;
+            value = (actual_pos_occ >= actual_neg_occ) ? true : false;
         }
     }
-    return std::make_tuple(chosen_literal, value);
-}
-
-/**
-* Return address of all literals in the clause
-*/
-std::unordered_set<Literal*> Clause::getAllLiterals() {
-    std::unordered_set<Literal*> s;
-    for (Literal* l : this->pos_literals_list) {
-        s.insert(l);
-    }
-    for (Literal* l : this->neg_literals_list) {
-        s.insert(l);
-    }
-    return s;
+    return std::make_tuple(chosen_variable, value);
 }
 
 /**
  * Print all data saving in data structure Literal and Clause.
  * Function is not use if variable print_process is not set to "true";
  */
-void Printer::printAllData() {
-    for (auto t : Literal::id2Lit) {
-        t.second->printData();
+void Solver::printAllData() {
+    for (Var v = 0; v < this->var_count; v++) {
+        this->printData(v);
+    }
+    for (CRef cr : this->list) {
+        if (!this->arena[cr].deleted) this->printData(this->arena[cr]);
     }
-    for (auto c : Clause::list) {
-        c->printData();
+    for (auto [l1, l2] : this->getBinaryClauses()) {
+        std::cout << "Binary clause - literals: " << Literal::toDIMACS(l1) << ", " << Literal::toDIMACS(l2) << std::endl;
     }
 }
 
 /**
- * Print assign values when SAT, branching variables or variables got flipped after backtracking.
+ * Print assign values of all variables when SAT, terminated by 0.
+ * Variables left free (in no clause or only in satisfied clauses) are printed as false.
  */
-void Printer::printResult() {
+void Solver::printResult() {
     std::cout << "v ";
     int variable_per_line_count = 0;
-    for (auto [bd, literal]: Literal::bd2BranLit) {
-        if (variable_per_line_count == 5) {
+    for (Var v = 0; v < this->var_count; v++) {
+        if (variable_per_line_count == 10) {
             std::cout << "\n" << "v ";
             variable_per_line_count = 0;
         }
-        if (literal->value == true) std::cout << literal->id << " ";
-        else std::cout << -abs(literal->id) << " ";
+        if (this->getValue(v)) std::cout << v + 1 << " ";
+        else std::cout << -(v + 1) << " ";
         variable_per_line_count++;
     }
-    std::cout << "\n" << "c" << "\n" << "v ";
-    variable_per_line_count = 0;
-    for (Literal* literal : Printer::solution) {
-        if (variable_per_line_count == 5) {
-            std::cout << "\n" << "v ";
-            variable_per_line_count = 0;
-        }
-        if (literal->value == true) std::cout << literal->id << " ";
-        else std::cout << -abs(literal->id) << " ";
-        variable_per_line_count++;
-    }
-    std::cout << std::endl;
+    std::cout << "0" << std::endl;
 }
 
 /**
  * Apply some preporecess methods
  */
-void Formula::preprocessing() {
-    Formula::removeInitialUnitClauses();
-    Formula::removeSATClauses();
-    Formula::pureLiteralsEliminate();
-//    Formula::NiVER();
+void Solver::preprocessing() {
+    this->removeInitialUnitClauses();
+    this->removeSATClauses();
+    // a pure literal may occur negated in a clause or an assumption of a later call
+    if (!this->incremental) this->pureLiteralsEliminate();
+    if (this->probing && !this->isUNSAT) this->probeLiterals();
+    // substituted variables are gone like eliminated ones
+    if (this->substitution && !this->incremental && !this->isUNSAT) this->substituteEquivalences();
+    if (!this->isUNSAT) this->subsumeClauses(false);
+    if (this->elimination && !this->incremental && !this->isUNSAT) this->eliminateVariables();
+    this->initPhases();
 }
 
 /**
  * Any unit clause with one literal will have that literal assign value by force
  */
-void Formula::removeInitialUnitClauses() {
-    if (Printer::print_CDCL_process) std::cout << "Finding initial unit clauses ..." << "\n";
-    for (auto c : Clause::list) {
-        int literal_count = c->pos_literals_list.size() + c->neg_literals_list.size();
-        if (literal_count == 1 && !c->free_literals.empty()) {
-            Literal* l = *(c->free_literals.begin()); // Error if free_literals is empty by previous loops
-            if (c->pos_literals_list.empty()) { // Only use this condition to finding suitable value in this case with initial unit clauses
-                l->assignValueCDCL(false, Assignment::IsForced);
+void Solver::removeInitialUnitClauses() {
+    if (this->print_CDCL_process) std::cout << "Finding initial unit clauses ..." << "\n";
+    for (CRef cr : this->list) {
+        Clause& c = this->arena[cr];
+        if (c.size == 1 && !c.deleted) {
+            Lit l = c.literals[0];
+            if (this->isFree(Literal::var(l))) {
+                this->assignValueCDCL(l);
+            } else if (this->isFalse(l)) {
+                this->isUNSAT = true; // two unit clauses with opposite literals
             }
-            else {
-                l->assignValueCDCL(true, Assignment::IsForced);
-            }
-            Printer::solution.insert(l);
         }
     }
-    if (Clause::CONFLICT) {
-        Formula::isUNSAT = true; // Conflict by initial unit clauses (all forced assignment) means unsatisfiable
+    if (this->CONFLICT) {
+        this->isUNSAT = true; // Conflict by initial unit clauses (all forced assignment) means unsatisfiable
     }
 }
 
 /**
  * Clauses having at least literal occur in both positive and negative are SAT by default and will be removed
  */
-void Formula::removeSATClauses(){
+void Solver::removeSATClauses(){
     // check basic SAT condition
     // check a clause contain a literal both pos and neg
-    if (Printer::print_CDCL_process) std::cout << "Finding initial SAT clauses..." << "\n";
-    for (const auto& id2ad : Literal::id2Lit) {
-        Literal* literal = id2ad.second;
+    if (this->print_CDCL_process) std::cout << "Finding initial SAT clauses..." << "\n";
+    for (CRef cr : this->list) {
+        Clause& c = this->arena[cr];
+        if (c.deleted) continue;
         // a literal appear both pos and neg in a clause, that clause is alway SAT, can remove from the process.
-        std::unordered_set<Clause*> intersect = findIntersection(literal->pos_occ, literal->neg_occ);
-        if (!intersect.empty()) {
-            for (Clause* c : intersect) {
-                if (Printer::print_CDCL_process) std::cout << "Clause " << c->id << " is SAT." << "\n";
-                c->deleteClause();
+        // literals are sorted at creation, so both literals of a variable are neighbours
+        for (uint32_t i = 1; i < c.size; i++) {
+            if (c.literals[i] == Literal::neg(c.literals[i - 1])) {
+                if (this->print_CDCL_process) std::cout << "Clause " << cr << " is SAT." << "\n";
+                this->deleteClause(c);
+                break;
             }
         }
     }
+    for (auto [l1, l2] : this->getBinaryClauses()) {
+        if (l1 == Literal::neg(l2)) this->deleteBinaryClause(l1, l2);
+    }
 }
 
 /**
@@ -413,117 +823,47 @@ void Formula::removeSATClauses(){
  * Pure literals can appear after remove SAT clauses from consideration.
  * Since pure literals are assigned to satisfy clauses, CONFLICT can't be raised.
  */
-void Formula::pureLiteralsEliminate() {
-    if (Printer::print_CDCL_process) std::cout << "Pure literal eliminating..." << "\n";
+void Solver::pureLiteralsEliminate() {
+    if (this->print_CDCL_process) std::cout << "Pure literal eliminating..." << "\n";
     bool new_pure_literal = true; // Flag if there is a new pure literal
     while (new_pure_literal) {// Loop until no new pure literal
         new_pure_literal = false;
-        for (const auto& id2ad : Literal::id2Lit) {
-            Literal* l = id2ad.second;
-            if (l->isFree) {
-                int actual_pos_occ = l->getActualPosOcc(INT_MAX);
-                int actual_neg_occ = l->getActualNegOcc(INT_MAX);
+        for (Var v = 0; v < this->var_count; v++) {
+            if (this->isFree(v) && !this->eliminated[v]) {
+                int actual_pos_occ = this->getActualOcc(Literal::makeLit(v, false), INT_MAX);
+                int actual_neg_occ = this->getActualOcc(Literal::makeLit(v, true), INT_MAX);
                 if (actual_pos_occ == 0) {
-                    l->assignValueCDCL(false, Assignment::IsForced);
+                    this->assignValueCDCL(Literal::makeLit(v, true));
+                    this->pure[v] = true;
                     new_pure_literal = true;
-                    Printer::solution.insert(l);
                 } else if (actual_neg_occ == 0) {
-                    l->assignValueCDCL(true, Assignment::IsForced);
+                    this->assignValueCDCL(Literal::makeLit(v, false));
+                    this->pure[v] = true;
                     new_pure_literal = true;
-                    Printer::solution.insert(l);
                 }
             }
         }
     }
 }
 
-
 /**
- * Delete variables using NiVER algorithms
- */
-void Formula::NiVER() {
-    bool change = true;
-    while (change) {
-        change = false;
-
-        for (auto [id, literal_x] : Literal::id2Lit) {
-            if (!literal_x->isFree) continue; // Skip assigned literals by previous preprocessing
-            // Find all possiable resolvent
-            int old_lit_count = 0;
-            int res_lit_count = 0;
-            std::vector<std::unordered_set<int>> resolvents_S; // resovented clauses in vector of int form
-            std::unordered_set<int> resol_holder;
-            for (Clause* x_pos_occ_clause : literal_x->pos_occ) {
-                std::unordered_set<Literal*> p1 = x_pos_occ_clause->getAllLiterals();
-                p1.erase(literal_x);
-                old_lit_count = old_lit_count + x_pos_occ_clause->pos_literals_list.size() + x_pos_occ_clause->neg_literals_list.size();
-
-                for (Clause* x_neg_occ_clause : literal_x->neg_occ) {
-                    std::unordered_set<Literal*> p2 = x_neg_occ_clause->getAllLiterals();
-                    p2.erase(literal_x);
-
-                    bool isTautology = false;
-                    for (Literal* y : p1) {
-                        if (y->pos_occ.contains(x_pos_occ_clause) && y->neg_occ.contains(x_neg_occ_clause)) {
-                            // xy... and -x-y...
-                            isTautology = true;
-                            break;
-                        } else if (y->neg_occ.contains(x_pos_occ_clause) && y->pos_occ.contains(x_neg_occ_clause)) {
-                            // x-y... and -xy...
-                            isTautology = true;
-                            break;
-                        }
-                    }
-                    if (isTautology) continue; // continue with next x_neg_occ_clause
-                    else { // add Res of p1 and p2 to S
-                        for (Literal* y : p1) {
-                            if (y->pos_occ.contains(x_pos_occ_clause)) resol_holder.insert(y->id);
-                            else resol_holder.insert(-(y->id));
-                            res_lit_count++;
-                        }
-                        for (Literal* y : p2) {
-                            if (y->pos_occ.contains(x_pos_occ_clause)) resol_holder.insert(y->id);
-                            else resol_holder.insert(-(y->id));
-                            res_lit_count++;
-                        }
-                        resolvents_S.push_back(resol_holder);
-                        resol_holder.clear();
-                    }
-                }
-            }
-            for (Clause* x_neg_occ_clause : literal_x->neg_occ) {
-                old_lit_count = old_lit_count + x_neg_occ_clause->pos_literals_list.size() + x_neg_occ_clause->neg_literals_list.size();
-            }
-            // Check SIZE and update data structure. Literal x got deleted by deleting all old clauses, disconnected from data structure
-            if (res_lit_count < old_lit_count
-                && resolvents_S.size() < literal_x->pos_occ.size() + literal_x->neg_occ.size()) {
-
-                for (Clause* c : literal_x->pos_occ) {
-                    std::cout<< c->id << "\n";
-                    c->deleteClause();
-                }
-                for (Clause* c : literal_x->neg_occ) {
-                    c->deleteClause();
-                }
-                change = true;
-                literal_x->isFree = false;  // hide from static field, can't set free again since no clause contain x
-                for (std::unordered_set<int> c : resolvents_S) {
-                    std::vector<int> tem_c = {};
-                    for (int l : c) {tem_c.push_back(l);}
-                    Clause::setNewClause(tem_c);
-                }
-                if (Printer::check_NiVER) std::cout << "Literal " << literal_x->id << " is deleted" << "\n";
-            }
-        }
-    }
-    if (Printer::check_NiVER) std::cout << "NiVER done" << "\n";
+ * Set CONFLICT flag for a binary clause with both literals false, it has no clause memory to refer to.
+ */
+void Solver::reportBinaryConflict(Lit l1, Lit l2) {
+    this->CONFLICT = true;
+    this->conflict_clause = CRef_Undef;
+    this->conflict_binary[0] = l1;
+    this->conflict_binary[1] = l2;
+    this->conflict_count++;
+    this->total_conflict_count++;
 }
 
 /**
  * Set CONFLICT flag. Save the conflict clause.
  */
-void Clause::reportConflict() {
-    Clause::CONFLICT = true;
-    Clause::conflict_clause = this;
-    Formula::conflict_count++;
+void Solver::reportConflict(Clause& clause) {
+    this->CONFLICT = true;
+    this->conflict_clause = this->arena.ref(clause);
+    this->conflict_count++;
+    this->total_conflict_count++;
 }
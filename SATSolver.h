@@ -2,195 +2,523 @@
 #define CDCL_SOLVER_SATSOLVER_H
 
 #include <vector>
-#include <stack>
+#include <string>
+#include <atomic>
 #include <tuple>
 #include <unordered_set>
 #include <queue>
 #include <algorithm>
 #include <unordered_map>
 #include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
 
 class Clause;
-class Literal;
-struct Assignment;
 
-class Literal {
+typedef uint32_t CRef; // offset of a clause inside ClauseArena::memory, replaces Clause* everywhere
+const CRef CRef_Undef = UINT32_MAX;
+
+typedef int Var; // dense variable index 0..var_count-1, DIMACS variable x is x-1
+typedef uint32_t Lit; // 2 * var + sign, sign is 1 for negative literals
+const Var Var_Undef = -1;
+const Lit Lit_Undef = UINT32_MAX;
+
+/**
+ * Entry of a watched list. "blocker" is another literal of the clause: if it is true the clause is SAT and skipped without reading the arena.
+ * Binary clauses have no clause memory at all: clause is CRef_Undef and blocker is the literal implied when the watched one becomes false.
+ */
+struct Watcher {
+    CRef clause;
+    Lit blocker;
+
+    bool isBinary() const {return clause == CRef_Undef;}
+};
+
+/**
+ * Edge of the implication graph kept by every forced literal:
+ * a clause in the arena, or for binary clauses the other (false) literal since they are not stored in the arena.
+ */
+struct Reason {
+    CRef clause = CRef_Undef;
+    Lit binary_literal = Lit_Undef;
+
+    bool isNone() const {return clause == CRef_Undef && binary_literal == Lit_Undef;}
+    static Reason binary(Lit l) {return {CRef_Undef, l};}
+};
+
+/**
+ * Binary max-heap of variables ordered by Solver::activity.
+ * "indices" holds the heap position of every variable (-1 if not in the heap), so a bumped variable is moved up in place.
+ */
+class VarOrderHeap {
 public:
-    const int id;
-    bool isFree = true; // decide if the literal is free to assign new value
-    bool value = false; // value of true or false, the literal always has a value during processing but consider has no value if it's free.
-    std::unordered_set<Clause*> pos_occ; // All positive/negative occurrences. Unchanged during solving process.
-    std::unordered_set<Clause*> neg_occ;
-    std::unordered_set<Clause*> pos_watched_occ;
-    std::unordered_set<Clause*> neg_watched_occ;
+    std::vector<Var> heap;
+    std::vector<int> indices;
+    const std::vector<double>* activity = nullptr; // activities of the owning solver
 
-    /** "reason":
-     * the clause which has the variable as the last unset literal(unit clause)
-     * unitPropagation use to trace back necessary value for assigning
-     * CDCL use to represent edges
-     * Always assigned right after the literal is pushed to unit_queue
-     */
-    Clause* reason = nullptr;
-    int branching_level = -1;
-
-    // For CDCL branching heuristics
-    int prioty_level = 1;
-    int learned_count = 0;
-
-    static int count;
-    static std::unordered_map<int, Literal*> id2Lit; // dictionary id to address
-    static std::unordered_set<int> id_list; // check if literal is already existed in database when creating clause
-    static std::queue<Literal*> unit_queue;
-    static std::unordered_map<int, Literal*> bd2BranLit; // storing all literals assigned by branching
-//    bool comparingPriorities = [](Literal* l1, Literal* l2) { return l1->prioty_level > l2->prioty_level;};
-    class Compare {
-    public:
-        bool operator()(Literal* l1, Literal* l2) {return l1->prioty_level > l2->prioty_level;}
-    };
-    static std::priority_queue<Literal*, std::vector<Literal*>, Compare> pq;
-
-    explicit Literal(int id) : id(id) {};
-    void updateStaticData();
-    void setFree();
-    void assignValueDPLL(bool, bool);
-    void assignValueCDCL(bool, bool);
-    void unassignValueDPLL();
-    void unassignValueCDCL();
-    int getActualPosOcc(int);
-    int getActualNegOcc(int);
-    void printData();
-    void deleteLiteral();
-
-    static void setLiteral(int l, Clause*);
-    static void updatePriorities();
+    bool empty() const {return heap.empty();}
+    bool contains(Var v) const {return v < static_cast<Var>(indices.size()) && indices[v] >= 0;}
+    void insert(Var v);
+    void increase(Var v);
+    Var removeMax();
+    void percolateUp(int i);
+    void percolateDown(int i);
+};
+
+/**
+ * Encoding of literals as Lit, independent of any solver.
+ */
+struct Literal {
+    static Var var(Lit l) {return static_cast<Var>(l >> 1);}
+    static bool sign(Lit l) {return l & 1;}
+    static Lit neg(Lit l) {return l ^ 1;}
+    static Lit makeLit(Var v, bool negative) {return 2 * v + negative;}
+    static Lit fromDIMACS(int l) {return makeLit(abs(l) - 1, l < 0);}
+    static int toDIMACS(Lit l) {return sign(l) ? -(var(l) + 1) : var(l) + 1;}
 };
 
+/**
+ * Contiguous storage for all clauses. Every clause is a small header followed by its packed literals,
+ * clauses are referenced by their 32-bit offset (CRef) instead of a pointer.
+ * Deleted clauses only count as wasted memory until Solver::collectGarbage() compacts the arena.
+ */
+class ClauseArena {
+public:
+    std::vector<uint32_t> memory;
+    uint32_t wasted = 0; // number of words used by deleted clauses
+
+    CRef alloc(const std::vector<Lit>& literals, bool learned);
+    void free(CRef cr);
+    CRef relocate(CRef cr, ClauseArena& to);
+    Clause& operator[](CRef cr) {return *reinterpret_cast<Clause*>(&memory[cr]);}
+    CRef ref(const Clause& c) const {return static_cast<CRef>(reinterpret_cast<const uint32_t*>(&c) - memory.data());}
+    uint32_t size() const {return memory.size();}
+    void clear();
+};
+
+/**
+ * View of a clause living in Solver::arena. Never constructed directly, only obtained by arena[cr].
+ * Header is followed in memory by "size" literals.
+ * The first two literals are the watched literals, satisfaction is derived from the literals' values and never stored.
+ * Pointers/references into the arena are invalidated by any allocation, keep CRef across calls which can add clauses.
+ */
 class Clause {
 public:
-    const int id; // for output to terminal, no value in solving process, can be discontinuous for learned clauses
-    std::unordered_set<Literal*> pos_literals_list; // List of positive/negative literals, unchanged during solving process
-    std::unordered_set<Literal*> neg_literals_list;
-    std::unordered_set<Literal*> free_literals = {};// List of free literals, reduce/add after one is assigned/unassigned
-    std::unordered_set<Literal*> sat_by = {}; // List of positive literals with value 1 and negative literal with value 0, making the clause SAT
-    Literal* watched_literal_1 = nullptr; // watched literals are set after clause is added
-    Literal* watched_literal_2 = nullptr;
-    bool SAT = false;
-
-    static int count; // clauses uses this to set id, initial with 1 instead of 0 because a clause is created with id = count before count got increment by 1.
-    static std::unordered_set<Clause*> list;
-    static bool CONFLICT;
-    static Clause* conflict_clause;
-    static int learned_clause_assertion_level;
-
-    explicit Clause(int id) : id(id) {};
-    void appendLiteral(Literal*, bool);
-    int getUnsetLiteralsCount() const;
-    void printData();
-    void updateStaticData();
-    void reportConflict();
-    std::unordered_set<Literal*> getAllLiterals();
-    int getWidth() const;
-    void setWatchedLiterals();
-    void deleteClause();
-
-    static void setNewClause(std::vector<int>& c);
-    static void conflictAnalyze();
-    static void unitPropagationDPLL();
-    static void unitPropagationCDCL();
-    static void learnCut(const std::unordered_set<Literal *>& cut);
-    static bool isDecisionCut(const std::unordered_set<Literal *>& cut);
-    static bool checkAllClausesSAT();
-    static bool isAsserting(const std::unordered_set<Literal *> &cut);
+    uint32_t size; // number of literals, unchanged during solving process
+    uint32_t learned : 1;
+    uint32_t deleted : 1; // disconnected from data structure, memory reclaimed by next garbage collection
+    uint32_t relocated : 1; // only during garbage collection, first literal then holds the new CRef
+    uint32_t used : 1; // learned clause took part in a conflict since the last reduceDB()
+    uint32_t lbd : 28; // learned clauses only, lowered when a conflict recomputes it smaller
+    float activity;
+    Lit literals[0];
 
+    Clause(const Clause&) = delete;
+    Lit* begin() {return literals;}
+    Lit* end() {return literals + size;}
+    int getWidth() const;
 };
 
-class LearnedClause: public Clause {
+/**
+ * Short learned clauses exported by one solver of a portfolio and read by all the others, without locks.
+ * The owning solver appends to a ring of fixed slots, every reader keeps its own position.
+ * A slot rewritten while it is read is detected by its sequence number, a reader too far behind skips the overwritten clauses.
+ */
+class ClauseExchange {
 public:
-    // TODO: more field for deleting strategies
+    static constexpr int capacity = 4096; // slots, the oldest clause is overwritten by a new one
+    static constexpr int max_size = 8; // longest clause fitting in a slot
 
-    static std::unordered_set<LearnedClause*> learned_list;
-    static int k_bounded_learning;
-    static int m_size_relevance_based_learning;
+    ClauseExchange() = default;
+    ClauseExchange(const ClauseExchange&) = delete;
+    void publish(const std::vector<Lit>& clause, int lbd);
+    bool read(uint64_t& position, std::vector<Lit>& clause, int& lbd) const;
 
-    explicit LearnedClause(int i) : Clause(i) {};
-    void updateLearnedStaticData();
-    void setWatchedLiteral(Literal*);
-    void deleteLearnedClause();
-    void setDeletionStrategyValue();
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0}; // 2 * position + 2 once written, odd while being written
+        std::atomic<int> size{0};
+        std::atomic<int> lbd{0};
+        std::atomic<Lit> literals[max_size];
+    };
+    Slot slots[capacity];
+    std::atomic<uint64_t> head{0}; // number of clauses published so far
+};
 
-    static void checkDeletion();
+/**
+ * Settings of a solver, filled from the command line and copied into every Solver.
+ */
+struct SolverOptions {
+    std::string branching_heuristic = "VSIDS"; // "VSIDS" or "VMTF"
+    std::string restart_policy = "luby";
+    std::string deletion_policy = "lbd";
+    std::string minimization_mode = "recursive";
+    int chrono_threshold = 100;
+    std::string initial_phase = "occurrence"; // "occurrence" (majority of occurrences), "true", "false" or "random"
+    bool target_phase = true; // branch on the values of the longest trail without conflict instead of the saved phases, VSIDS only
+    int rephase_interval = 1000; // conflicts between rephasings grow by this, 0 disables rephasing
+    unsigned random_seed = 0;
+    int verbosity = 1;
+    int time_limit = 300000; // in milliseconds
+    const std::atomic<bool>* interrupt = nullptr; // solve() gives up once it is set, shared by the solvers of a portfolio
+    std::vector<ClauseExchange*> shared_clauses; // one buffer per solver of a portfolio, empty if learned clauses aren't shared
+    int solver_index = 0; // own buffer in shared_clauses
+    bool incremental = false; // clauses and assumptions may use any variable after the first solve(), pure literals are kept
+    bool elimination = true; // bounded variable elimination in preprocessing, off when incremental
+    bool probing = false; // failed literal probing in preprocessing
+    bool substitution = true; // equivalent literal substitution in preprocessing, off when incremental
 };
 
+struct DIMACSScanner;
+
 /**
- * Assignment is pushed to stack directly in constructor without calling any function.
+ * One independent solver: it owns the formula, the assignment and all search data, nothing is shared between instances.
+ * Solvers can run concurrently on different threads, an instance is solved by one solver and freed by destroying it.
+ * Used incrementally, clauses are added by addClause() between solve() calls, which keep learned clauses, activities and phases.
+ * Data is grouped by what the former static classes held: Literal, Clause, LearnedClause, Assignment, Formula, Printer and Heuristic.
  */
-struct Assignment {
-    bool status;
-    Literal* assigned_literal;
+class Solver {
+public:
+    explicit Solver(const SolverOptions& options = {});
+    Solver(const Solver&) = delete;
+    Solver& operator=(const Solver&) = delete;
+
+    int time_limit; // in milliseconds
+    const std::atomic<bool>* interrupt; // nullptr if the search can only stop by itself or by time_limit
 
-    Assignment(bool status, Literal* lit) : status(status), assigned_literal(lit) {};
+    bool readDIMACS(const std::string& path);
+    bool addClause(std::vector<Lit> literals);
+    int solve(const std::vector<Lit>& assumptions = {});
+    int value(Var v) const {return values[2 * v];} // in the model of the last SAT solve(): 1 true, -1 false
+    const std::vector<Lit>& failedAssumptions() const {return failed_assumptions;}
+    std::vector<std::vector<Lit>> splitCubes(int depth);
 
-    static std::stack<Assignment*> stack;
-    static std::vector<std::stack<Assignment*>> assignment_history; // Not used
-    static bool enablePrintAll;
-    static std::string branching_heuristic;
-    static int bd;
+    /*
+     * Literal: all variable and literal data in struct-of-arrays form, indexed by Var or Lit.
+     * Arrays are sized from the "p cnf" header and grown by setLiteral() if a clause uses a larger variable.
+     */
+    // indexed by Lit
+    std::vector<int8_t> values; // 1 true, -1 false, 0 free. Both literals of a variable are set together so checking one is a single lookup
+    std::vector<std::vector<CRef>> occ; // All occurrences in the arena. Only changed when clauses are added or deleted, not used by propagation.
+    std::vector<std::vector<Watcher>> watched_occ; // Clauses watching the literal, visited only when that literal becomes false
 
-    // Code more readable
-    const static bool IsForced = true;
-    const static bool IsBranching = false;
+    // indexed by Var
+    /** "reason":
+     * the clause which has the variable as the last unset literal(unit clause)
+     * CDCL use to represent edges
+     * Assigned together with the value when the literal is forced
+     */
+    std::vector<Reason> reason;
+    std::vector<int> branching_level; // -1 while free
+    std::vector<double> activity; // For CDCL branching heuristics, bumped by var_inc when learned
+    std::vector<bool> eliminated; // removed from the formula by eliminateVariables(), never branched on, valued by extendModel()
+    std::vector<bool> pure; // assigned at depth 0 by pureLiteralsEliminate(), not implied by the formula
+    std::vector<int8_t> seen; // marks of conflict analysis, cleared before it returns
+    // branching polarity, 1 true, -1 false, 0 not set
+    std::vector<int8_t> saved_phase; // last value, saved when unassigned
+    std::vector<int8_t> target_phase; // values of the longest trail without conflict since the last rephasing
+    std::vector<int8_t> best_phase; // values of the longest trail without conflict since "best" was last used
+    std::vector<int8_t> original_phase; // majority of occurrences after preprocessing
 
-    void updateStaticData();
-    static void backtrackingDPLL();
-    static void backtrackingCDCL();
-    static void branchingDPLL();
-    static void branchingCDCL();
+    double var_inc = 1; // grows by 1 / var_decay every conflict instead of decaying all activities
+    double var_decay = 0.95;
+    VarOrderHeap order_heap; // free variables, plus assigned ones not popped yet
 
-};
+    // VMTF queue, doubly linked from the least to the most recently bumped variable
+    std::vector<Var> vmtf_prev;
+    std::vector<Var> vmtf_next;
+    std::vector<uint64_t> vmtf_stamp; // enqueue time, increasing along the queue
+    Var vmtf_first = Var_Undef;
+    Var vmtf_last = Var_Undef;
+    Var vmtf_search = Var_Undef; // every variable after it in the queue is assigned
+    uint64_t vmtf_stamp_count = 0;
 
+    bool isTrue(Lit l) const {return values[l] > 0;}
+    bool isFalse(Lit l) const {return values[l] < 0;}
+    bool isFree(Var v) const {return values[2 * v] == 0;}
+    bool getValue(Var v) const {return values[2 * v] > 0;}
 
-struct Formula {
-    static bool isSAT;
-    static bool isUNSAT;
-    static int var_count;
-    static int clause_count;
-    static int branching_count;
-    static int conflict_count;
-    static int conflict_count_limit;
-
-    static void restart();
-    static void preprocessing();
-    static void removeInitialUnitClauses();
-    static void removeSATClauses();
-    static void pureLiteralsEliminate();
-    static void NiVER();
-};
+    void init(int var_count);
+    void assignValueDPLL(Lit, Reason = {});
+    void assignValueCDCL(Lit, Reason = {});
+    int getReasonLevel(const Reason&);
+    void unassignValueDPLL(Var);
+    void unassignValueCDCL(Var);
+    void updateWatchedClauses(Lit);
+    int getActualOcc(Lit, int);
+    void printData(Var);
 
-struct Printer {
-    static bool print_process;
-    static bool print_parsing_result;
-    static bool print_formula;
-    static bool print_CDCL_process;
-    static bool print_assignment;
-    static bool print_learned_clause;
-    static bool print_max_depth_literal;
-    static bool check_delete_process;
-    static bool check_restart_process;
-    static bool check_NiVER;
-    static std::unordered_set<Literal*> solution;
-
-    static void printAssignmentStack();
-    static void printAssignmentHistory();
-    static void printAllData();
-    static void printResult();
+    Lit setLiteral(int l, CRef);
+    void bumpActivity(Var);
+    void decayActivities();
+    void enqueueVMTF(Var);
+    void dequeueVMTF(Var);
+    void bumpVMTF(const std::vector<Var>&);
 
-};
+    /*
+     * Clause: the arena holding all clauses, and the data of conflict analysis.
+     */
+    ClauseArena arena;
+    std::vector<CRef> list; // deleted clauses are skipped and dropped by garbage collection
+    bool CONFLICT = false;
+    CRef conflict_clause = CRef_Undef; // CRef_Undef when the conflict is a binary clause, see conflict_binary
+    Lit conflict_binary[2] = {Lit_Undef, Lit_Undef};
+    int learned_clause_assertion_level = 0;
+    int learned_clause_lbd = 0; // number of different depths in the last learned clause
+    std::vector<Lit> learned_literals; // buffer of conflict analysis, reused for every conflict
+    std::vector<Var> analyze_seen_vars; // variables marked seen by the last conflict analysis
+    std::vector<Lit> minimize_stack;
+    std::string minimization_mode; // "recursive", "local" or "none"
+    std::vector<uint64_t> lbd_stamp; // indexed by depth, for counting depths without clearing
+    uint64_t lbd_stamp_count = 0;
+    Lit learned_asserting_literal = Lit_Undef; // literal of max depth, assigned by backtrackingCDCL() once the assertion level is reached
+    Reason learned_asserting_reason;
+
+    bool SAT(Clause& clause);
+    int getUnsetLiteralsCount(Clause& clause);
+    void printData(Clause& clause);
+    void reportConflict(Clause& clause);
+    void setWatchedLiterals(Clause& clause);
+    void unwatch(Clause& clause);
+    void deleteClause(Clause& clause);
+
+    CRef setNewClause(std::vector<Lit>& c);
+    CRef addSimplifiedClause(std::vector<Lit>& c, bool learned = false, int lbd = 0);
+    void setNewBinaryClause(Lit l1, Lit l2);
+    void deleteBinaryClause(Lit l1, Lit l2);
+    void reportBinaryConflict(Lit l1, Lit l2);
+    std::vector<std::pair<Lit, Lit>> getBinaryClauses();
+    void conflictAnalyze();
+    void analyzeFinal(Lit p);
+    void unitPropagationDPLL();
+    void unitPropagationCDCL();
+    void learnCut(std::vector<Lit>& learned);
+    void assertMissedImplication();
+    void minimizeLearned(std::vector<Lit>& learned);
+    bool isRedundant(Lit p, uint32_t abstract_levels);
+    uint32_t abstractLevel(Var v);
+    bool checkAllClausesSAT();
+    int computeLBD(const Lit* begin, const Lit* end);
+    void collectGarbage();
+
+    /*
+     * LearnedClause: learned clauses share the arena layout of Clause and are marked by the "learned" flag in the header.
+     * They are kept in three tiers by LBD: core (lbd <= core_lbd) is never deleted, tier2 (lbd <= tier2_lbd) is kept while used,
+     * local clauses and unused tier2 clauses are halved by reduceDB() every reduce_interval (+ reduce_increment per reduction) conflicts.
+     */
+    std::vector<CRef> learned_list;
+    int core_lbd = 2;
+    int tier2_lbd = 6;
+    int reduce_interval = 2000;
+    int reduce_increment = 300;
+    int reduce_count = 0;
+    long long next_reduce = 2000;
+    double cla_inc = 1;
+    double cla_decay = 0.999;
+    std::string deletion_policy; // "lbd" (tiers), "activity" or "none"
+
+    bool isLocked(Clause& clause);
+
+    CRef setNewLearnedClause(std::vector<Lit>& c);
+    void bumpClauseActivity(CRef cr);
+    void decayClauseActivities();
+    void reduceDB();
+
+    /*
+     * Assignment: assignments are kept in the trail, a vector of literals in assignment order reserved for all variables, so assigning never allocates.
+     * Depth d starts at trail index level_start[d - 1] with its branching literal, backtracking is a truncation of the trail.
+     * Literals from propagation_head on are assigned but their falsified watched lists are not visited yet (propagation queue).
+     */
+    std::vector<Lit> trail;
+    std::vector<int> level_start;
+    int propagation_head = 0;
+    std::vector<std::vector<std::string>> assignment_history; // Not used
+    bool enablePrintAll = true;
+    std::string branching_heuristic;
+    int bd = 0;
+    int chrono_threshold; // backjumps over more depths are replaced by chronological backtracking, negative to disable
+    std::vector<Lit> assumptions; // literals of the current solve() call, branched on first, each on its own depth
+    size_t assumption_head = 0; // assumptions before it are true, reset by backtracking
+    Lit failed_assumption = Lit_Undef; // assumption found false, the formula is UNSAT under the assumptions
+    std::vector<Lit> failed_assumptions; // failed_assumption and the assumptions forcing it false, see analyzeFinal()
+
+    bool isPropagated() const {return propagation_head == static_cast<int>(trail.size());}
+    bool isBranching(int trail_index) const {
+        int level = branching_level[Literal::var(trail[trail_index])];
+        return level > 0 && level_start[level - 1] == trail_index;
+    }
+    Lit getBranchingLiteral(int level) const {return trail[level_start[level - 1]];}
+    void newBranchingLevel();
+    void cancelUntil(int level);
+    void backtrackingDPLL();
+    void backtrackingCDCL();
+    void branchingDPLL();
+    void branchingCDCL();
+    bool decide(Lit l);
+    void undoDecisions(int level);
+    Var lookaheadVariable();
+    void splitCube(std::vector<Lit>& cube, int depth, std::vector<std::vector<Lit>>& cubes);
+
+    /*
+     * Formula: status and statistics of the instance, and the restart schedule.
+     */
+    bool isSAT = false;
+    bool isUNSAT = false;
+    bool preprocessed = false; // preprocessing() runs only before the first search
+    bool incremental;
+    int var_count = 0;
+    int clause_count = 0;
+    int branching_count = 0; // since the last restart, assumptions included
+    long long decision_count = 0; // branching literals chosen by the heuristic in all solve() calls
+    int conflict_count = 0; // since the last restart
+    int conflict_count_limit = 100;
+    long long total_conflict_count = 0;
+    long long propagation_count = 0; // literals whose watched clauses were visited
+    long long learned_literal_count = 0; // before minimization
+    long long chrono_backtrack_count = 0;
+    long long minimized_literal_count = 0; // after minimization
+
+    /** "restart_policy":
+     * "geometric": restart after conflict_count_limit conflicts, limit grows by 1.5
+     * "luby": restart after luby_unit * luby(i) conflicts
+     * "glucose": restart when the fast moving average of learned clause LBD exceeds the slow one by restart_margin,
+     * blocked while the trail is much longer than its average, since the solver may be close to a model
+     */
+    std::string restart_policy;
+    int restart_count = 0;
+    int luby_unit = 100;
+    double lbd_ema_fast = 0;
+    double lbd_ema_slow = 0;
+    double trail_ema = 0;
+    double restart_margin = 1.25;
+    double blocking_margin = 1.4;
+
+    static double luby(int i);
+    void updateRestartData(int lbd, int trail_size);
+    bool shouldRestart();
+    void restart();
+    void preprocessing();
+    void removeInitialUnitClauses();
+    void removeSATClauses();
+    void pureLiteralsEliminate();
+
+    /*
+     * Elimination: bounded variable elimination of preprocessing, in Preprocessing.cpp.
+     * A variable is replaced by the resolvents of its clauses if that doesn't add clauses, the removed clauses are kept
+     * on the elimination stack to give eliminated variables their values in a model.
+     */
+    bool elimination;
+    int elimination_product_limit = 400; // variables with more pairs of clauses to resolve are kept
+    int elimination_occurrence_limit = 16; // variables with more clauses of one polarity are kept
+    int elimination_resolvent_limit = 20; // longest resolvent allowed
+    long long elimination_effort = 10; // literals merged by resolution per literal of the formula
+    long long elimination_budget = 0; // literals merged by resolution left in the pass
+    int eliminated_count = 0;
+    std::vector<Lit> elimination_stack; // removed clauses, each with the eliminated literal first and followed by its size
+
+    long long countLiterals();
+    void eliminateVariables();
+    bool eliminateVariable(Var x, std::vector<Var>& touched);
+    int occurrenceCount(Lit l);
+    void collectOccurrences(Lit l, std::vector<std::vector<Lit>>& clauses);
+    bool resolve(const std::vector<Lit>& c1, const std::vector<Lit>& c2, Var x, std::vector<Lit>& resolvent);
+    bool findGate(Lit x, const std::vector<std::vector<Lit>>& pos_clauses, const std::vector<std::vector<Lit>>& neg_clauses,
+                  std::vector<bool>& pos_gate, std::vector<bool>& neg_gate);
+    void extendModel();
 
-struct Heuristic {
-    static std::tuple<Literal*, bool> MOM();
-    static std::tuple<Literal*, bool> VSIDS();
-//    static std::tuple<Literal*, bool> BerkMin();
-//    static std::tuple<Literal*, bool> VMTF();
+    /*
+     * Probing: failed literals and equivalent literals found on the binary implication graph, in Preprocessing.cpp.
+     * A substituted variable is replaced by its equivalent literal everywhere and counts as eliminated,
+     * the elimination stack gives it the value of that literal in a model.
+     */
+    bool probing;
+    bool substitution;
+    long long probing_effort = 10; // literals propagated by probing per literal of the formula
+    int failed_literal_count = 0;
+    int substituted_count = 0;
 
+    void probeLiterals();
+    void substituteEquivalences();
+
+    /*
+     * Subsumption: backward subsumption and self-subsuming resolution, in Preprocessing.cpp.
+     * Runs on the original clauses in preprocessing and on the learned clauses at depth 0 every subsume_interval conflicts.
+     */
+    int subsume_interval = 5000;
+    long long next_subsume = 5000;
+    long long subsumption_step_limit = 10000000; // clause pairs compared by the pass on the original clauses
+    double subsumption_effort = 0.1; // clause pairs compared by a pass on the learned clauses per literal propagated since the last one
+    long long subsume_propagations = 0; // propagation_count at the last pass
+    std::vector<std::vector<int>> subsume_occ; // indices of the candidates of a pass by literal, emptied but kept for the next pass
+    long long subsumed_count = 0;
+    long long strengthened_count = 0;
+
+    static uint64_t clauseSignature(const std::vector<Lit>& literals);
+    void subsumeClauses(bool learned);
+    CRef strengthenClause(CRef cr, Lit l, std::vector<Lit>& literals);
+
+    /*
+     * Sharing: short learned clauses exchanged with the other solvers of a portfolio.
+     * All solvers preprocess the same formula the same way, so a clause learned by one holds for all of them.
+     */
+    std::vector<ClauseExchange*> shared_clauses;
+    int solver_index;
+    std::vector<uint64_t> shared_positions; // next clause to import from each buffer
+    std::vector<Lit> shared_literals; // buffer of importing, reused for every clause
+    int share_lbd_limit = 2; // learned clauses up to this LBD are exported, unit and binary clauses always
+    long long exported_count = 0;
+    long long imported_count = 0;
+
+    void exportLearned(const std::vector<Lit>& learned);
+    void importSharedClauses();
+    void addSharedClause(std::vector<Lit>& clause, int lbd);
+
+    /*
+     * Printer: output switches, the debug flags are set from the verbosity.
+     */
+    bool print_process = false;
+    bool print_parsing_result = false;
+    bool print_formula = false;
+    bool print_CDCL_process = false;
+    bool print_assignment = false;
+    bool print_learned_clause = false;
+    bool print_max_depth_literal = false;
+    bool check_delete_process = false;
+    bool check_restart_process = false;
+    bool check_elimination = false;
+    int verbosity; // 0 only "s" and "v" lines, 1 adds "c" statistics
+
+    void printAssignmentStack();
+    void printAssignmentHistory();
+    void printAllData();
+    void printResult();
+
+    /*
+     * Heuristic: branching variable and polarity.
+     */
+    std::tuple<Var, bool> MOM();
+    std::tuple<Var, bool> VSIDS();
+//    std::tuple<Var, bool> BerkMin();
+    std::tuple<Var, bool> VMTF();
+    bool choosePolarity(Var);
+
+    std::string initial_phase; // "occurrence", "true", "false" or "random", see initPhases()
+    bool use_target_phase;
+    int rephase_interval; // conflicts between rephasings grow by this, 0 disables rephasing
+    int rephase_count = 0;
+    long long next_rephase = 0;
+    int target_assigned = 0; // trail size saved in target_phase
+    int best_assigned = 0; // trail size saved in best_phase
+    std::mt19937 random_generator;
+    int lookahead_candidates = 16; // variables of most occurrences tried by lookaheadVariable()
+
+    void initPhases();
+    void updateTargetPhases();
+    void rephase();
+
+private:
+    bool parseDIMACS(DIMACSScanner& scanner, const std::string& path);
 };
+
 #endif //CDCL_SOLVER_SATSOLVER_H
\ No newline at end of file
@@ -1,98 +1,244 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <chrono>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "SATSolver.h"
 
 using namespace std;
 namespace fs = std::filesystem;
 
-// Declare static variable
-// Literal:
-int Literal::count = 0;
-unordered_map<int, Literal*> Literal::id2Lit = {};
-unordered_set<int> Literal::id_list = {};
-queue<Literal*> Literal::unit_queue= {};
-std::unordered_map<int, Literal*> Literal::bd2BranLit;
-std::priority_queue<Literal*, std::vector<Literal*>, Literal::Compare> Literal::pq;
-// Clause:
-int Clause::count = 1;
-bool Clause::CONFLICT = false;
-Clause* Clause::conflict_clause = nullptr;
-std::unordered_set<Clause*> Clause::list = {};
-std::unordered_set<LearnedClause*> LearnedClause::learned_list = {};
-int Clause::learned_clause_assertion_level = 0;
-// Learned CLause:
-int LearnedClause::k_bounded_learning = 15;
-int LearnedClause::m_size_relevance_based_learning = 5;
-// Assignment:
-stack<Assignment*> Assignment::stack = {};
-vector<stack<Assignment*>> Assignment::assignment_history = {};
-int Assignment::bd = 0;
-bool Assignment::enablePrintAll = true;
-string Assignment::branching_heuristic = "VSIDS";
-
-// Formula
-bool Formula::isSAT = false;
-bool Formula::isUNSAT = false;
-int Formula::var_count = 0;
-int Formula::clause_count = 0;
-int Formula::branching_count = 0;
-int Formula::conflict_count = 0;
-int Formula::conflict_count_limit = 100;
-
 // Declare function
-vector<vector<int>> readDIMACS(const string& path);
-void parse(const vector<vector<int>>& formula);
-void reset();
 //DPLL
 void runDPLL(const std::string&);
 //CDCL
-void runCDCL(const std::string&);
+int runCDCL(const std::string&);
+int runPortfolio(const std::string&);
+int runCubes(const std::string&);
+void runBatch(const std::vector<std::string>&);
 
 // Global definition
-int MAX_RUN_TIME = 300000; // Determine max runtime for solver, in milisecond.
-std::chrono::duration<double, std::milli> run_time = std::chrono::high_resolution_clock::duration::zero();
+SolverOptions OPTIONS; // settings of every solver, from the command line
+int THREAD_COUNT = 1;
+bool SHARE_CLAUSES = true; // between the solvers of a portfolio
+int CUBE_DEPTH = 0; // cube-and-conquer splits a single file into at most 2^CUBE_DEPTH cubes, 0 for portfolio or sequential solving
+string SUMMARY_FORMAT = "csv"; // "csv" or "json", summary of a directory
+
+/**
+ * Outcome of one instance of a directory, a line of the batch summary.
+ */
+struct BatchResult {
+    string path;
+    string status = "ERROR"; // SAT, UNSAT, UNKNOWN when the time ran out, ERROR when the file can't be read
+    double run_time = 0; // in milliseconds, reading included
+    long long conflicts = 0;
+    long long decisions = 0;
+    long long propagations = 0;
+};
+
+/**
+ * Print the command line options.
+ * @param out cout for --help, cerr after a wrong command line
+ */
+void printUsage(std::ostream& out) {
+    out << "Usage: CDCL_Solver [options] file|dir" << "\n"
+         << "Solve a DIMACS CNF file (also gzip, xz or bzip2 compressed), or every file of a directory." << "\n"
+         << "Exit code of a single file: 10 SAT, 20 UNSAT, 0 unknown, 1 on errors." << "\n"
+         << "  --timeout=SECONDS        time limit per instance (default " << OPTIONS.time_limit / 1000 << ")" << "\n"
+         << "  --heuristic=vsids|vmtf   branching heuristic (default vsids)" << "\n"
+         << "  --restart=luby|glucose|geometric   restart policy (default luby)" << "\n"
+         << "  --deletion=lbd|activity|none       learned clause deletion policy (default lbd)" << "\n"
+         << "  --minimize=recursive|local|none    learned clause minimization (default recursive)" << "\n"
+         << "  --chrono=DEPTHS|off      chronological backtracking over longer backjumps (default 100)" << "\n"
+         << "  --elim=on|off            bounded variable elimination in preprocessing (default on)" << "\n"
+         << "  --probe=on|off           failed literal probing in preprocessing (default off)" << "\n"
+         << "  --subst=on|off           equivalent literal substitution in preprocessing (default on)" << "\n"
+         << "  --phase=occurrence|true|false|random  initial phase of variables (default occurrence)" << "\n"
+         << "  --target=on|off          branch on target phases, the values of the longest trail without conflict," << "\n"
+         << "                           used with vsids only, vmtf always takes saved phases (default on)" << "\n"
+         << "  --rephase=CONFLICTS|off  reset phases to original, inverted, best or random ones every growing interval (default 1000)" << "\n"
+         << "  --seed=N                 seed of random decisions (default 0)" << "\n"
+         << "  --threads=N              number of threads: a file is solved by a portfolio of N differently configured" << "\n"
+         << "                           solvers, the first to finish stops the others; a directory is solved N files at a time (default 1)" << "\n"
+         << "  --cubes=DEPTH            cube-and-conquer: split a file by lookahead into at most 2^DEPTH cubes," << "\n"
+         << "                           solved by N workers under assumptions (default 0, off)" << "\n"
+         << "  --share=on|off           exchange short learned clauses between the solvers of a portfolio (default on)" << "\n"
+         << "  --summary=csv|json       format of the summary printed after a directory (default csv)" << "\n"
+         << "  --verbosity=0..3         0 only result lines, 1 statistics, 2 search events, 3 trace (default 1)" << "\n"
+         << "  -q, -v                   same as --verbosity=0 and --verbosity=2" << "\n"
+         << "  -h, --help               print this help" << "\n";
+}
 
-// variables controlling output to terminal
-bool Printer::print_parsing_result = false;
-bool Printer::print_formula = false;
-bool Printer::print_process = false;
-bool Printer::print_CDCL_process = false;
-bool Printer::print_assignment = false;
-bool Printer::print_learned_clause = false;
-bool Printer::print_max_depth_literal = false;
-bool Printer::check_delete_process = false;
-bool Printer::check_restart_process = false;
-bool Printer::check_NiVER = true;
-std::unordered_set<Literal*> Printer::solution = {};
+/**
+ * Read a non-negative integer option value.
+ * @param value Text of the value
+ * @param result Parsed value, unchanged on errors
+ * @return false if the value is not a number
+ */
+bool parseCount(const string& value, int& result) {
+    if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != string::npos) return false;
+    result = stoi(value);
+    return true;
+}
 
-int main() {
+int main(int argc, char* argv[]) {
     string path;
-    string select;
-    cout << R"(Solve multiple SAT instances ("y" to run on a folder or "n" to run on a single file)?: )" << "\n";
-    getline(cin, select);
-    if (select == "y") {
-        cout << "Please enter the full directory to the folder: " << "\n";
-        getline(cin, path);
-//        cout << R"(Do you want to disable printing all assignments history("y" to disable)?: )" << endl;
-//        getline(cin, select);
-//        if (select == "y") Assignment::enablePrintAll = false;
-        for (const auto & entry : fs::directory_iterator(path)) {
-            std::cout << entry.path().string() << std::endl;
-            runCDCL(entry.path().string());
-            std::cout << "-------------------------" << endl;
+    int& verbosity = OPTIONS.verbosity;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string name = arg.substr(0, arg.find('='));
+        string value = arg.find('=') == string::npos ? "" : arg.substr(arg.find('=') + 1);
+        if (arg == "-h" || arg == "--help") {
+            printUsage(cout);
+            return 0;
+        } else if (arg == "-q") {
+            verbosity = 0;
+        } else if (arg == "-v") {
+            verbosity = 2;
+        } else if (name == "--verbosity") {
+            if (!parseCount(value, verbosity) || verbosity > 3) {
+                cerr << "Invalid verbosity " << value << " (0 to 3)" << endl;
+                return 1;
+            }
+        } else if (name == "--timeout") {
+            int seconds;
+            if (!parseCount(value, seconds) || seconds == 0 || seconds > INT_MAX / 1000) {
+                cerr << "Invalid timeout " << value << " (positive number of seconds)" << endl;
+                return 1;
+            }
+            OPTIONS.time_limit = seconds * 1000;
+        } else if (name == "--heuristic") {
+            if (value == "vsids" || value == "vmtf") {
+                OPTIONS.branching_heuristic = value == "vsids" ? "VSIDS" : "VMTF";
+            } else {
+                cerr << "Unknown heuristic " << value << " (vsids or vmtf)" << endl;
+                return 1;
+            }
+        } else if (name == "--restart") {
+            OPTIONS.restart_policy = value;
+            if (value != "luby" && value != "glucose" && value != "geometric") {
+                cerr << "Unknown restart policy " << value << " (luby, glucose or geometric)" << endl;
+                return 1;
+            }
+        } else if (name == "--deletion") {
+            OPTIONS.deletion_policy = value;
+            if (value != "lbd" && value != "activity" && value != "none") {
+                cerr << "Unknown deletion policy " << value << " (lbd, activity or none)" << endl;
+                return 1;
+            }
+        } else if (name == "--minimize") {
+            OPTIONS.minimization_mode = value;
+            if (value != "recursive" && value != "local" && value != "none") {
+                cerr << "Unknown minimization mode " << value << " (recursive, local or none)" << endl;
+                return 1;
+            }
+        } else if (name == "--chrono") {
+            if (value == "off") {
+                OPTIONS.chrono_threshold = -1;
+            } else if (!parseCount(value, OPTIONS.chrono_threshold)) {
+                cerr << "Invalid chronological backtracking threshold " << value << " (number of depths or off)" << endl;
+                return 1;
+            }
+        } else if (name == "--target") {
+            if (value != "on" && value != "off") {
+                cerr << "Invalid target phase " << value << " (on or off)" << endl;
+                return 1;
+            }
+            OPTIONS.target_phase = value == "on";
+        } else if (name == "--rephase") {
+            if (value == "off") {
+                OPTIONS.rephase_interval = 0;
+            } else if (!parseCount(value, OPTIONS.rephase_interval)) {
+                cerr << "Invalid rephase interval " << value << " (number of conflicts or off)" << endl;
+                return 1;
+            }
+        } else if (name == "--elim") {
+            if (value != "on" && value != "off") {
+                cerr << "Invalid variable elimination " << value << " (on or off)" << endl;
+                return 1;
+            }
+            OPTIONS.elimination = value == "on";
+        } else if (name == "--probe") {
+            if (value != "on" && value != "off") {
+                cerr << "Invalid probing " << value << " (on or off)" << endl;
+                return 1;
+            }
+            OPTIONS.probing = value == "on";
+        } else if (name == "--subst") {
+            if (value != "on" && value != "off") {
+                cerr << "Invalid substitution " << value << " (on or off)" << endl;
+                return 1;
+            }
+            OPTIONS.substitution = value == "on";
+        } else if (name == "--phase") {
+            OPTIONS.initial_phase = value;
+            if (value != "occurrence" && value != "true" && value != "false" && value != "random") {
+                cerr << "Unknown initial phase " << value << " (occurrence, true, false or random)" << endl;
+                return 1;
+            }
+        } else if (name == "--seed") {
+            int seed;
+            if (!parseCount(value, seed)) {
+                cerr << "Invalid seed " << value << " (non-negative number)" << endl;
+                return 1;
+            }
+            OPTIONS.random_seed = seed;
+        } else if (name == "--threads") {
+            if (!parseCount(value, THREAD_COUNT) || THREAD_COUNT == 0) {
+                cerr << "Invalid thread count " << value << " (positive number)" << endl;
+                return 1;
+            }
+        } else if (name == "--cubes") {
+            if (!parseCount(value, CUBE_DEPTH) || CUBE_DEPTH > 20) {
+                cerr << "Invalid cube depth " << value << " (0 to 20)" << endl;
+                return 1;
+            }
+        } else if (name == "--share") {
+            if (value != "on" && value != "off") {
+                cerr << "Invalid clause sharing " << value << " (on or off)" << endl;
+                return 1;
+            }
+            SHARE_CLAUSES = value == "on";
+        } else if (name == "--summary") {
+            if (value != "csv" && value != "json") {
+                cerr << "Unknown summary format " << value << " (csv or json)" << endl;
+                return 1;
+            }
+            SUMMARY_FORMAT = value;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            cerr << "Unknown option " << arg << endl;
+            printUsage(cerr);
+            return 1;
+        } else if (path.empty()) {
+            path = arg;
+        } else {
+            cerr << "Only one file or directory can be solved, got " << path << " and " << arg << endl;
+            return 1;
         }
-    } else if (select == "n") {
-        cout << "Please enter the full directory to the file: " << "\n";
-        getline(cin, path);
-        runCDCL(path);
-    } else {
-        cerr << "Invalid input!" << endl;
     }
-    return 0;
+    if (path.empty()) {
+        printUsage(cerr);
+        return 1;
+    }
+
+    std::error_code error;
+    if (fs::is_directory(path, error)) {
+        // every instance gets its own result, the exit code only reports errors
+        vector<string> files;
+        for (const auto& entry : fs::directory_iterator(path, error)) {
+            if (entry.is_regular_file()) files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        runBatch(files);
+        return error ? 1 : 0;
+    }
+    if (CUBE_DEPTH > 0) return runCubes(path);
+    return THREAD_COUNT > 1 ? runPortfolio(path) : runCDCL(path);
 }
 
 ///**
@@ -102,244 +248,424 @@ int main() {
 //*/
 //void runDPLL(const std::string& path) {
 //    auto start_time = std::chrono::high_resolution_clock::now();
+//    std::chrono::duration<double, std::milli> run_time{0};
+//    Solver solver(OPTIONS);
 //
-//    //read DIMACS file, return formula in vector<vector<int>>
-//    vector<vector<int>> formula = readDIMACS(path);
-//
-//    if (!formula.empty()) {
-//        // parse formula into data structures
-//        parse(formula);
+//    //read DIMACS file into data structures
+//    if (solver.readDIMACS(path)) {
 //        simplify();
-//        while (!Formula::isSAT && !Formula::isUNSAT && run_time.count() < MAX_RUN_TIME && !Clause::CONFLICT) {
-//            Clause::unitPropagationDPLL();
-//            if (Literal::unit_queue.empty() && !Clause::CONFLICT) {
-//                pureLiteralsEliminate();
+//        while (!solver.isSAT && !solver.isUNSAT && run_time.count() < solver.time_limit && !solver.CONFLICT) {
+//            solver.unitPropagationDPLL();
+//            if (solver.isPropagated() && !solver.CONFLICT) {
+//                solver.pureLiteralsEliminate();
 //            }
-//            if (!Formula::isSAT && !Formula::isUNSAT && Literal::unit_queue.empty() && !Clause::CONFLICT) {
-//                Assignment::branchingDPLL();
+//            if (!solver.isSAT && !solver.isUNSAT && solver.isPropagated() && !solver.CONFLICT) {
+//                solver.branchingDPLL();
 //            }
-//            if (Clause::CONFLICT) {
-//                Assignment::backtrackingDPLL();
+//            if (solver.CONFLICT) {
+//                solver.backtrackingDPLL();
 //            }
-//            Formula::isSAT = Clause::checkAllClausesSAT();
+//            solver.isSAT = solver.checkAllClausesSAT();
 //            run_time = std::chrono::high_resolution_clock::now() - start_time; // update runtime
 //        }
 //
 //        // Output result
-//        if (Formula::isSAT) {
+//        if (solver.isSAT) {
 //            cout << "The problem is satisfiable!" << "\n";
-//            Printer::printAssignmentStack();
-//            //Assignment::printAssignmentHistory();
-//        } else if (Formula::isUNSAT) {
+//            solver.printAssignmentStack();
+//            //solver.printAssignmentHistory();
+//        } else if (solver.isUNSAT) {
 //            cout << "The problem is unsatisfiable!" << "\n";
-//            Printer::printAssignmentStack();
-//            //Assignment::printAssignmentHistory();
+//            solver.printAssignmentStack();
+//            //solver.printAssignmentHistory();
 //        } else {
 //            cout << "Time run out!" << "\n";
-//            Printer::printAssignmentStack();
+//            solver.printAssignmentStack();
 //        }
-//    } else if (formula.empty()) {
+//    } else {
 //        cerr << "File at " << path << " is empty or error opening!" << endl;
 //    }
 //
 //    auto end_time = std::chrono::high_resolution_clock::now();
 //    run_time = end_time - start_time;
 //    std::cout << "Runtime: " << run_time.count() << "ms" << endl;
-//    reset();
 //}
 
+/**
+ * Print the "s" and "v" lines of a finished search, and its statistics if the verbosity is at least 1.
+ *
+ * @param solver Solver after solve()
+ * @param exit_code Result of solve()
+ */
+void printOutcome(Solver& solver, int exit_code) {
+    if (exit_code == 10) {
+        cout << "s SATISFIABLE" << "\n";
+        solver.printResult();
+    } else if (exit_code == 20) {
+        cout << "s UNSATISFIABLE" << "\n";
+    } else {
+        cout << "s UNKNOWN" << "\n";
+        if (OPTIONS.verbosity >= 1) cout << "c TIMEOUT" << "\n";
+    }
+    if (OPTIONS.verbosity >= 1) {
+        cout << "c Conflicts " << solver.total_conflict_count << ", decisions " << solver.decision_count
+             << ", propagations " << solver.propagation_count << ", restarts " << solver.restart_count << "\n";
+        if (solver.learned_literal_count > 0) {
+            cout << "c Minimization removed " << solver.learned_literal_count - solver.minimized_literal_count << " of "
+                 << solver.learned_literal_count << " learned literals" << "\n";
+        }
+        if (solver.chrono_backtrack_count > 0) cout << "c Chronological backtracks " << solver.chrono_backtrack_count << "\n";
+        if (solver.subsumed_count + solver.strengthened_count > 0) {
+            cout << "c Subsumed clauses " << solver.subsumed_count << ", strengthened " << solver.strengthened_count << "\n";
+        }
+        if (solver.failed_literal_count + solver.substituted_count > 0) {
+            cout << "c Failed literals " << solver.failed_literal_count << ", substituted variables " << solver.substituted_count << "\n";
+        }
+        if (solver.eliminated_count > 0) cout << "c Eliminated variables " << solver.eliminated_count << " of " << solver.var_count << "\n";
+        if (solver.exported_count + solver.imported_count > 0) {
+            cout << "c Shared clauses exported " << solver.exported_count << ", imported " << solver.imported_count << "\n";
+        }
+    }
+}
+
 /**
  * run CDCL solver on a file with DIMACS format in CNF form
+ * A new Solver is created for the instance, its data is freed when it goes out of scope.
  *
  * @param path  Directory of DIMACS file, require a full directory, could be plattform sensitive.
+ * @return SAT competition exit code: 10 SAT, 20 UNSAT, 0 unknown, 1 if the file can't be read
 */
-void runCDCL(const std::string& path) {
+int runCDCL(const std::string& path) {
     auto start_time = std::chrono::high_resolution_clock::now();
+    int exit_code = 1;
+    Solver solver(OPTIONS);
 
-    vector<vector<int>> formula = readDIMACS(path);
-
-    if (!formula.empty()) {
-        std::cout << "Start solving with TIMEOUT fixed to " << MAX_RUN_TIME/1000 << "s"<< "\n";
-        parse(formula);
-        Formula::preprocessing();
-        while (!Formula::isSAT && !Formula::isUNSAT && run_time.count() < MAX_RUN_TIME) {
-            Clause::unitPropagationCDCL();
-            if (!Formula::isSAT && !Formula::isUNSAT && Literal::unit_queue.empty() && !Clause::CONFLICT) {
-                Assignment::branchingCDCL();
-            }
-            if (!Formula::isSAT && !Formula::isUNSAT && Clause::CONFLICT) {
-                if (Formula::conflict_count == Formula::conflict_count_limit) {
-                    Formula::restart();
-                } else {
-                    Clause::conflictAnalyze();
-                    if (!Formula::isUNSAT) {
-                        Assignment::backtrackingCDCL();
-                        LearnedClause::checkDeletion();
-                    }
-                }
-            }
-            Formula::isSAT = Clause::checkAllClausesSAT();
-            run_time = std::chrono::high_resolution_clock::now() - start_time;
-        }
-
-        // Output result
-        if (Formula::isSAT) {
-            cout << "s SATISFIABLE" << "\n";
-            Printer::printResult();
-        } else if (Formula::isUNSAT) {
-            cout << "s UNSATISFIABLE" << "\n";
-        } else {
-            cout << "s UNKNOWN - TIMEOUT" << "\n";
-        }
-    } else if (formula.empty()) {
-        cerr << "File at " << path << " is empty or there are errors when opening!" << endl;
+    if (solver.readDIMACS(path)) {
+        if (OPTIONS.verbosity >= 1) std::cout << "c Start solving with TIMEOUT fixed to " << solver.time_limit/1000 << "s"<< "\n";
+        exit_code = solver.solve();
+        printOutcome(solver, exit_code);
+    } else {
+        cerr << "File at " << path << " is empty or there are errors when reading!" << endl;
     }
-    auto end_time = std::chrono::high_resolution_clock::now();
-    run_time = end_time - start_time;
-    std::cout << "c Done (runtime is " << run_time.count() << "ms)" << std::endl;
-    reset();
+    std::chrono::duration<double, std::milli> run_time = std::chrono::high_resolution_clock::now() - start_time;
+    if (OPTIONS.verbosity >= 1) std::cout << "c Done (runtime is " << run_time.count() << "ms)" << "\n";
+    std::cout << std::flush;
+    return exit_code;
 }
 
 /**
- * Reset all static and global variable, necessary for solving multiple instances in a single project run.
-*/
-void reset() {
-    if (Printer::print_process) cout << "Data reseted" << endl;
+ * Settings of the i-th solver of a portfolio. Solver 0 keeps the command line settings, the others cycle through
+ * combinations of heuristic, restart policy, initial phase and target phase, and all get a different seed, so they search differently.
+ * Target phases are only used by VSIDS, so the VMTF configurations have them off.
+ * Only solver 0 prints search events.
+ *
+ * @param i Index of the solver in the portfolio
+ */
+SolverOptions portfolioOptions(int i) {
+    struct Configuration {const char* heuristic; const char* restart; const char* phase; bool target;};
+    static const Configuration configurations[] = {
+            {"VMTF", "glucose", "occurrence", false},
+            {"VSIDS", "glucose", "false", true},
+            {"VMTF", "luby", "true", false},
+            {"VSIDS", "geometric", "random", false},
+            {"VMTF", "geometric", "false", false},
+            {"VSIDS", "luby", "random", true},
+    };
+    SolverOptions options = OPTIONS;
+    if (i == 0) return options;
+    const Configuration& configuration = configurations[(i - 1) % 6];
+    options.branching_heuristic = configuration.heuristic;
+    options.restart_policy = configuration.restart;
+    options.initial_phase = configuration.phase;
+    options.target_phase = configuration.target;
+    options.random_seed = OPTIONS.random_seed + i;
+    options.verbosity = 0;
+    return options;
+}
 
-    Literal::count = 0;
-    for (auto [id, l] : Literal::id2Lit) {
-        delete l;
+/**
+ * run a portfolio of THREAD_COUNT solvers on a file, each on its own thread with the settings of portfolioOptions().
+ * Short learned clauses are exchanged through one ClauseExchange per solver unless SHARE_CLAUSES is off.
+ * The first solver proving SAT or UNSAT sets the shared interrupt flag, the others give up at their next loop.
+ * Every solver reads the file itself, solver 0 first so errors are reported once.
+ *
+ * @param path  Directory of DIMACS file
+ * @return SAT competition exit code of the winner: 10 SAT, 20 UNSAT, 0 unknown, 1 if the file can't be read
+ */
+int runPortfolio(const std::string& path) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::atomic<bool> interrupt{false};
+    std::atomic<int> winner{-1};
+    vector<std::unique_ptr<ClauseExchange>> exchanges;
+    vector<ClauseExchange*> shared_clauses;
+    for (int i = 0; SHARE_CLAUSES && i < THREAD_COUNT; i++) {
+        exchanges.push_back(std::make_unique<ClauseExchange>());
+        shared_clauses.push_back(exchanges.back().get());
     }
-    Literal::id_list.clear();
-    Literal::id2Lit.clear();
-    while (!Literal::unit_queue.empty()){Literal::unit_queue.pop();}
-    Literal::bd2BranLit.clear();
-    while (!Literal::pq.empty()) {Literal::pq.pop();}
-
-    Clause::count = 0;
-    for (auto c : Clause::list) {
-        delete c;
+    vector<std::unique_ptr<Solver>> solvers;
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        SolverOptions options = portfolioOptions(i);
+        options.interrupt = &interrupt;
+        options.shared_clauses = shared_clauses;
+        options.solver_index = i;
+        solvers.push_back(std::make_unique<Solver>(options));
+    }
+    if (!solvers[0]->readDIMACS(path)) {
+        cerr << "File at " << path << " is empty or there are errors when reading!" << endl;
+        return 1;
+    }
+    if (OPTIONS.verbosity >= 1) {
+        std::cout << "c Start solving with TIMEOUT fixed to " << OPTIONS.time_limit/1000 << "s, portfolio of " << THREAD_COUNT << " solvers" << "\n";
     }
-    Clause::list.clear();
-    Clause::CONFLICT = false;
-    Clause::conflict_clause = nullptr;
-    Clause::learned_clause_assertion_level = 0;
-    LearnedClause::learned_list.clear();
-
-    while (!Assignment::stack.empty()) {Assignment::stack.pop();}
-    Assignment::assignment_history.clear();
-    Assignment::bd = 0;
 
-    Formula::isSAT = false;
-    Formula::isUNSAT = false;
-    Formula::clause_count = 0;
-    Formula::var_count = 0;
-    Formula::branching_count = 0;
-    Formula::conflict_count = 0;
-    Formula::conflict_count_limit = 100;
+    vector<int> exit_codes(THREAD_COUNT, 0);
+    auto search = [&](int i) {
+        if (i > 0 && !solvers[i]->readDIMACS(path)) return;
+        exit_codes[i] = solvers[i]->solve();
+        int none = -1;
+        if (exit_codes[i] != 0 && winner.compare_exchange_strong(none, i)) interrupt = true;
+    };
+    vector<std::thread> threads;
+    for (int i = 1; i < THREAD_COUNT; i++) threads.emplace_back(search, i);
+    search(0);
+    for (std::thread& t : threads) t.join();
 
-    Printer::solution.clear();
-    run_time = std::chrono::high_resolution_clock::duration::zero();
+    int i = std::max(winner.load(), 0);
+    Solver& solver = *solvers[i];
+    if (OPTIONS.verbosity >= 1 && winner >= 0) {
+        cout << "c Solved by portfolio solver " << i << " (" << solver.branching_heuristic << ", " << solver.restart_policy
+             << " restarts, " << solver.initial_phase << " phase)" << "\n";
+    }
+    printOutcome(solver, exit_codes[i]);
+    std::chrono::duration<double, std::milli> run_time = std::chrono::high_resolution_clock::now() - start_time;
+    if (OPTIONS.verbosity >= 1) std::cout << "c Done (runtime is " << run_time.count() << "ms)" << "\n";
+    std::cout << std::flush;
+    return exit_codes[i];
 }
 
 /**
- * Read DIMACS file and parse to vector of vector form
- * @param path file's name or path to the file
- * @return SAT instance type vector<vector<int>>
+ * Cubes waiting for a worker of cube-and-conquer. The owner takes cubes from the front, idle workers steal from the back.
  */
-vector<vector<int>> readDIMACS(const string& path) {
-    std::ifstream infile(path);
+struct CubeQueue {
+    std::mutex mutex;
+    std::deque<std::vector<Lit>> cubes;
+};
 
-    if (!infile.is_open()) {
-        std::cerr << "Error opening file " << path << std::endl;
-        return {};
-    } else if (infile.is_open() && Printer::print_CDCL_process) {
-        cout << "File opened" << endl;
+/**
+ * Take the next cube of a worker, from its own queue or else stolen from another one.
+ * @param queues Queues of all workers
+ * @param i Index of the worker
+ * @param cube Taken cube
+ * @return false if all queues are empty
+ */
+bool takeCube(vector<CubeQueue>& queues, size_t i, vector<Lit>& cube) {
+    for (size_t k = 0; k < queues.size(); k++) {
+        CubeQueue& queue = queues[(i + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.cubes.empty()) continue;
+        if (k == 0) {
+            cube = std::move(queue.cubes.front());
+            queue.cubes.pop_front();
+        } else {
+            cube = std::move(queue.cubes.back());
+            queue.cubes.pop_back();
+        }
+        return true;
     }
+    return false;
+}
 
-    vector<vector<int>> formula;
-    vector<int> clause_holder;
+/**
+ * run cube-and-conquer on a file. A lookahead solver splits the formula into cubes of CUBE_DEPTH decisions,
+ * then THREAD_COUNT workers solve them under assumptions, each keeping its learned clauses from cube to cube.
+ * The formula is SAT as soon as one cube is, then all workers stop; it is UNSAT when every cube is refuted.
+ * Splitter and workers are built from the same options, so they preprocess the formula identically: cube literals never use
+ * a variable eliminated or substituted by preprocessing, which the workers could not take as assumption.
+ *
+ * @param path  Directory of DIMACS file
+ * @return SAT competition exit code: 10 SAT, 20 UNSAT, 0 unknown, 1 if the file can't be read
+ */
+int runCubes(const std::string& path) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::atomic<bool> interrupt{false};
+    SolverOptions options = OPTIONS;
+    options.verbosity = 0;
+    options.interrupt = &interrupt;
+    Solver splitter(options);
+    if (!splitter.readDIMACS(path)) {
+        cerr << "File at " << path << " is empty or there are errors when reading!" << endl;
+        return 1;
+    }
+    if (OPTIONS.verbosity >= 1) std::cout << "c Start solving with TIMEOUT fixed to " << OPTIONS.time_limit/1000 << "s, cube-and-conquer" << "\n";
+    vector<vector<Lit>> cubes = splitter.splitCubes(CUBE_DEPTH);
+    std::chrono::duration<double, std::milli> split_time = std::chrono::high_resolution_clock::now() - start_time;
+    if (OPTIONS.verbosity >= 1) cout << "c Split into " << cubes.size() << " cubes in " << split_time.count() << "ms" << "\n";
 
-    std::string line;
-    while (std::getline(infile, line)) {
-        std::istringstream iss(line);
-        if (line.empty()) continue;
-        std::string token;
-        iss >> token; // first word/number of the line;
+    std::atomic<int> winner{-1};
+    std::atomic<size_t> refuted{0};
+    int worker_count = splitter.isUNSAT ? 0 : std::min<int>(THREAD_COUNT, static_cast<int>(cubes.size()));
+    vector<CubeQueue> queues(worker_count);
+    for (size_t i = 0; i < cubes.size() && worker_count > 0; i++) queues[i % worker_count].cubes.push_back(std::move(cubes[i]));
+    vector<std::unique_ptr<Solver>> solvers;
+    for (int i = 0; i < worker_count; i++) solvers.push_back(std::make_unique<Solver>(options));
 
-        if (token == "c") { // comments will be ignored
-            continue;
-        } else if (token == "p") {
-            iss >> token; // "cnf"
-            if (!(token == "cnf")) { // only read CNF form
-                std::cerr << "Error reading cnf format" << std::endl;
-                return {};
+    auto work = [&](int i) {
+        Solver& solver = *solvers[i];
+        if (!solver.readDIMACS(path)) return;
+        vector<Lit> cube;
+        while (!interrupt && takeCube(queues, i, cube)) {
+            std::chrono::duration<double, std::milli> run_time = std::chrono::high_resolution_clock::now() - start_time;
+            solver.time_limit = OPTIONS.time_limit - static_cast<int>(run_time.count());
+            if (solver.time_limit <= 0) return;
+            int exit_code = solver.solve(cube);
+            if (exit_code == 20 && !solver.isUNSAT) {
+                refuted++;
+            } else if (exit_code != 0) {
+                // a model, or a refutation without assumptions, decides the formula
+                int none = -1;
+                if (winner.compare_exchange_strong(none, i)) interrupt = true;
+                return;
             } else {
-                // parse number of variables and clauses
-                iss >> token;
-                Formula::var_count = std::stoi(token);
-                iss >> token;
-                Formula::clause_count = std::stoi(token);
-            }
-        } else if (token == "0") { // if the line start with 0, will also be ignored
-            formula.emplace_back(clause_holder); // add clause to formula
-            clause_holder.clear(); // reset holder
-            continue;
-        } else { // not c or p or 0, if file in correct format, this should be a number presenting variable or literal
-            int variable = std::stoi(token);
-            clause_holder.emplace_back(variable); // add first variable to holder
-            while (iss >> token) { // if not end of the line
-                if (token == "0") {
-                    formula.emplace_back(clause_holder); // when meet 0 as token, add finished clause to formula
-                    clause_holder.clear(); // reset holder
-                    break;
-                }
-                variable = std::stoi(token);
-                clause_holder.emplace_back(variable);
+                return;
             }
         }
+    };
+    vector<std::thread> threads;
+    for (int i = 1; i < worker_count; i++) threads.emplace_back(work, i);
+    if (worker_count > 0) work(0);
+    for (std::thread& t : threads) t.join();
+
+    int exit_code = 0;
+    if (winner >= 0) {
+        exit_code = solvers[winner]->isSAT ? 10 : 20;
+    } else if (splitter.isUNSAT || refuted == cubes.size()) {
+        exit_code = 20;
     }
-    if (Printer::print_CDCL_process) {
-        cout << "Finished read file " << path << endl;
+    if (exit_code == 10) {
+        cout << "s SATISFIABLE" << "\n";
+        solvers[winner]->printResult();
+    } else if (exit_code == 20) {
+        cout << "s UNSATISFIABLE" << "\n";
+    } else {
+        cout << "s UNKNOWN" << "\n";
+        if (OPTIONS.verbosity >= 1) cout << "c TIMEOUT" << "\n";
     }
-    if (Printer::print_formula) {
-        cout << "Solving SAT instance: " << "\n";
-        for (const auto& c : formula) {
-            for (auto v : c) {
-                cout << v << " ";
-            }
-            cout << "\n";
+    if (OPTIONS.verbosity >= 1) {
+        long long conflicts = 0, decisions = 0, propagations = 0;
+        for (const auto& solver : solvers) {
+            conflicts += solver->total_conflict_count;
+            decisions += solver->decision_count;
+            propagations += solver->propagation_count;
         }
+        cout << "c Cubes refuted " << refuted << " of " << cubes.size() << " by " << worker_count << " workers" << "\n";
+        cout << "c Conflicts " << conflicts << ", decisions " << decisions << ", propagations " << propagations << "\n";
     }
-    return formula;
+    std::chrono::duration<double, std::milli> run_time = std::chrono::high_resolution_clock::now() - start_time;
+    if (OPTIONS.verbosity >= 1) std::cout << "c Done (runtime is " << run_time.count() << "ms)" << "\n";
+    std::cout << std::flush;
+    return exit_code;
 }
 
 /**
- * parse all clauses and literals from the SAT instance to data structures
- * @param formula SAT instance
+ * Solve one file of a directory. The solver prints nothing, its result and statistics are returned for the summary.
+ *
+ * @param path  Directory of DIMACS file
+ * @return Status, runtime and statistics of the instance
  */
-void parse(const vector<vector<int>>& formula) {
-    if (Printer::print_CDCL_process) cout << "Start parsing..." << "\n";
-    for (auto c : formula){
-        Clause::setNewClause(c);
+BatchResult solveInstance(const std::string& path) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BatchResult result;
+    result.path = path;
+    SolverOptions options = OPTIONS;
+    options.verbosity = 0; // output of concurrent solvers would interleave
+    Solver solver(options);
+
+    if (solver.readDIMACS(path)) {
+        int exit_code = solver.solve();
+        result.status = exit_code == 10 ? "SAT" : exit_code == 20 ? "UNSAT" : "UNKNOWN";
+        result.conflicts = solver.total_conflict_count;
+        result.decisions = solver.decision_count;
+        result.propagations = solver.propagation_count;
     }
+    std::chrono::duration<double, std::milli> run_time = std::chrono::high_resolution_clock::now() - start_time;
+    result.run_time = run_time.count();
+    return result;
+}
 
-    // Print out all parsed data
-    if (Printer::print_parsing_result) {
-        cout << "Number of literals: " << Literal::id2Lit.size() << "\n";
-        cout << "Number of clauses: " << Clause::list.size() << "\n";
-        Printer::printAllData();
-        cout<<"Finish parsing"<<"\n";
+/**
+ * Quote a path for the summary.
+ * @param path File path
+ * @param json JSON string if true, else a CSV field which is only quoted when it contains a comma, quote or line break
+ */
+string quotePath(const string& path, bool json) {
+    if (!json && path.find_first_of(",\"\r\n") == string::npos) return path;
+    string quoted = "\"";
+    for (char c : path) {
+        if (c == '"') quoted += json ? "\\\"" : "\"\"";
+        else if (json && c == '\\') quoted += "\\\\";
+        else if (json && static_cast<unsigned char>(c) < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        } else quoted += c;
     }
+    return quoted + "\"";
 }
 
-///**
-// * Implement some techniques to simplify SAT instance.
-// */
-//void simplify() {
-//    if (Printer::print_process) cout << "Start simplifying" << "\n";
-//    removeSATClauses();
-//    removeInitialUnitClauses();
-//    if (Printer::print_process) cout << "Finish simplifying" << endl;
-//}
+/**
+ * Solve all files of a directory with THREAD_COUNT worker threads, every file by its own Solver and --timeout.
+ * Files are started from the largest, so a long instance doesn't run alone at the end of the sweep.
+ * A progress line is printed when an instance finishes, the summary in SUMMARY_FORMAT is printed at the end in the order of files.
+ *
+ * @param files Regular files of the directory, sorted by name
+ */
+void runBatch(const std::vector<std::string>& files) {
+    vector<size_t> order(files.size());
+    vector<uintmax_t> sizes(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        std::error_code error;
+        order[i] = i;
+        sizes[i] = fs::file_size(files[i], error);
+        if (error) sizes[i] = 0;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t i1, size_t i2) {return sizes[i1] > sizes[i2];});
 
+    vector<BatchResult> results(files.size());
+    std::atomic<size_t> next{0};
+    size_t finished = 0;
+    std::mutex output_mutex;
+    auto worker = [&]() {
+        for (size_t k = next++; k < order.size(); k = next++) {
+            BatchResult result = solveInstance(files[order[k]]);
+            std::lock_guard<std::mutex> lock(output_mutex);
+            finished++;
+            if (OPTIONS.verbosity >= 1) {
+                cout << "c [" << finished << "/" << files.size() << "] " << result.path << " " << result.status
+                     << " " << static_cast<long long>(result.run_time) << "ms" << endl;
+            }
+            results[order[k]] = std::move(result);
+        }
+    };
+    vector<std::thread> workers;
+    for (int i = 1; i < std::min<int>(THREAD_COUNT, static_cast<int>(files.size())); i++) workers.emplace_back(worker);
+    worker();
+    for (std::thread& t : workers) t.join();
+
+    if (SUMMARY_FORMAT == "json") {
+        cout << "[" << "\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BatchResult& r = results[i];
+            cout << "  {\"file\": " << quotePath(r.path, true) << ", \"status\": \"" << r.status << "\", \"runtime_ms\": "
+                 << r.run_time << ", \"conflicts\": " << r.conflicts << ", \"decisions\": " << r.decisions
+                 << ", \"propagations\": " << r.propagations << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        cout << "]" << "\n";
+    } else {
+        cout << "file,status,runtime_ms,conflicts,decisions,propagations" << "\n";
+        for (const BatchResult& r : results) {
+            cout << quotePath(r.path, false) << "," << r.status << "," << r.run_time << "," << r.conflicts << ","
+                 << r.decisions << "," << r.propagations << "\n";
+        }
+    }
+    cout << std::flush;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <algorithm>
+#include "SATSolver.h"
+
+/**
+ * Checks of the incremental Solver API: clauses added between solve() calls, assumptions, failed assumptions and model values.
+ * Exit code 0 if all checks pass, 1 otherwise.
+ */
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+Lit lit(int dimacs) {return Literal::fromDIMACS(dimacs);}
+
+int main() {
+    SolverOptions options;
+    options.verbosity = 0;
+    options.incremental = true;
+
+    {
+        Solver solver(options);
+        solver.addClause({lit(1), lit(2), lit(3)});
+        solver.addClause({lit(1), lit(-2)});
+        check(solver.solve() == 10, "(1 2 3)(1 -2) is SAT");
+        check(solver.value(0) == 1 || solver.value(1) == 1 || solver.value(2) == 1, "model satisfies (1 2 3)");
+
+        // 1 is pure in the first call, a new clause may still negate it
+        check(solver.addClause({lit(-1)}), "incremental solver takes clauses after solve()");
+        check(solver.solve() == 10, "adding -1 keeps the formula SAT");
+        check(solver.value(0) == -1 && solver.value(1) == -1 && solver.value(2) == 1, "model is -1 -2 3");
+
+        check(solver.solve({lit(2)}) == 20 && !solver.isUNSAT, "assumption 2 fails, the formula stays SAT");
+        const std::vector<Lit>& failed = solver.failedAssumptions();
+        check(std::find(failed.begin(), failed.end(), lit(2)) != failed.end(), "failed assumptions contain 2");
+
+        check(solver.solve({lit(5)}) == 10 && solver.var_count == 5, "assumption on a new variable adds it");
+        check(solver.value(4) == 1, "model keeps assumption 5");
+
+        solver.addClause({lit(-3)});
+        check(solver.solve() == 20 && solver.isUNSAT, "adding -3 makes the formula UNSAT");
+    }
+
+    {
+        options.incremental = false;
+        Solver solver(options);
+        solver.addClause({lit(1), lit(2), lit(3)});
+        solver.addClause({lit(1), lit(-2)});
+        check(solver.solve() == 10, "non-incremental (1 2 3)(1 -2) is SAT");
+        check(!solver.addClause({lit(-1)}), "non-incremental solver refuses clauses after solve()");
+        check(solver.solve() == 10, "refused clause leaves the formula SAT");
+        // preprocessing fixed the pure literal 1, yet -1 -2 3 satisfies the formula
+        check(solver.solve({lit(-1)}) == 0 && !solver.isUNSAT, "assumption negating a pure literal is refused, not failed");
+        check(solver.solve({lit(1)}) == 10 && solver.value(0) == 1, "assumption of a pure literal is kept");
+    }
+
+    if (failures == 0) std::cout << "All checks passed" << "\n";
+    return failures == 0 ? 0 : 1;
+}